@@ -0,0 +1,80 @@
+#include "sparkland/tick_parser.h"
+#include "sparkland/ticker_generator.h"
+#include "sparkland/types.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Per-tick cost of TickParser::parse_and_push on realistic ticker messages (the feed
+// simulator's synthetic feed), the regression check for changes to the parser hot path.
+// Each run parses the whole corpus into the tick ring, draining it as it goes; min and
+// median over the runs are reported, compare them between builds on an idle machine.
+//
+// Usage: sparkland_parser_bench [messages] [runs] [passes]
+
+namespace {
+
+// Keeps the compiler from dropping the reads of the parsed ticks
+volatile double sink;
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t messages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    size_t runs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 15;
+    size_t passes = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 50;
+    if (messages == 0 || runs == 0 || passes == 0) {
+        std::fprintf(stderr, "Usage: sparkland_parser_bench [messages] [runs] [passes]\n");
+        return 1;
+    }
+
+    sparkland::FeedProfile profile;
+    sparkland::TickerGenerator generator(profile);
+    std::vector<simdjson::padded_string> corpus;
+    corpus.reserve(messages);
+    int64_t now_ns = 1757234872369411000;
+    for (size_t i = 0; i < messages; ++i) {
+        corpus.emplace_back(generator.next(now_ns + static_cast<int64_t>(i) * 100000));
+    }
+
+    sparkland::TickRingBuffer ring;
+    sparkland::TickParser parser(ring, generator.products());
+
+    auto run_once = [&]() {
+        size_t failed = 0;
+        double checksum = 0.0;
+        for (const auto& payload : corpus) {
+            if (!parser.parse_and_push(payload)) ++failed;
+            if (sparkland::Tick* tick = ring.acquire_filled_slot()) {
+                checksum += tick->price_ema;
+                ring.release_slot();
+            }
+        }
+        sink = checksum;
+        return failed;
+    };
+
+    // Warm up caches, branch predictors and the parser's buffers
+    if (run_once() > 0) {
+        std::fprintf(stderr, "Corpus didn't parse cleanly\n");
+        return 1;
+    }
+
+    std::vector<double> ns_per_tick;
+    for (size_t run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass) run_once();
+        double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ns_per_tick.push_back(elapsed_ns / static_cast<double>(messages * passes));
+    }
+    std::sort(ns_per_tick.begin(), ns_per_tick.end());
+
+    std::printf("parse_and_push: %zu messages x %zu passes, %zu runs\n", messages, passes, runs);
+    std::printf("ns/tick: min %.1f  median %.1f  max %.1f\n", ns_per_tick.front(),
+                ns_per_tick[ns_per_tick.size() / 2], ns_per_tick.back());
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "sparkland/snapshot_cache.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Fuzz target for TickParser: every input is parsed as a single message and as a batch, then
+// the published ticks and bars are checked for unterminated fixed size fields. Crashes, ASan
+// reports and traps are findings. Seed inputs are in fuzz/corpus.
+//
+// libFuzzer (clang):  -fsanitize=fuzzer,address, see SPARKLAND_BUILD_FUZZERS
+// AFL / replay (gcc): define SPARKLAND_FUZZ_STANDALONE, inputs are read from the files given
+
+namespace {
+
+using namespace sparkland;
+
+template <size_t N>
+void check_terminated(const char (&field)[N]) {
+    if (std::memchr(field, '\0', N) == nullptr) __builtin_trap();
+}
+
+struct FuzzState {
+    TickRingBuffer ring;
+    BarRingBuffer bars;
+    SnapshotCache cache{{"BTC-USD", "ETH-USD"}};
+    TickParser parser{ring, {"BTC-USD", "ETH-USD"}, &cache, &bars};
+
+    void drain() {
+        while (Tick* tick = ring.acquire_filled_slot()) {
+            check_terminated(tick->type);
+            check_terminated(tick->product_id);
+            check_terminated(tick->side);
+            check_terminated(tick->time);
+            ring.release_slot();
+        }
+        while (Bar* bar = bars.acquire_filled_slot()) {
+            check_terminated(bar->product_id);
+            bars.release_slot();
+        }
+    }
+};
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // Kept across inputs like in production, books and EMAs see whatever earlier inputs left
+    static FuzzState state;
+
+    simdjson::padded_string payload(reinterpret_cast<const char*>(data), size);
+    state.parser.parse_and_push(payload);
+    state.drain();
+    state.parser.parse_batch(payload);
+    state.drain();
+    return 0;
+}
+
+#ifdef SPARKLAND_FUZZ_STANDALONE
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <input>...\n", argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "Can't read %s\n", argv[i]);
+            return 1;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include "sparkland/huge_pages.h"
+
+namespace sparkland {
+
+// Bump allocator for per-message (or per-batch) scratch memory.
+// Owned by one thread, allocations are released all at once by reset().
+class Arena {
+public:
+    explicit Arena(size_t capacity)
+        : m_storage(capacity), m_base(static_cast<char*>(m_storage.data())), m_capacity(capacity) {}
+    ~Arena() = default;
+
+    // Delete copy/move operations
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = delete;
+    Arena& operator=(Arena&&) = delete;
+
+    // nullptr when the arena is exhausted, the caller picks its own fallback
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        size_t offset = (m_used + alignment - 1) & ~(alignment - 1);
+        if (offset > m_capacity || bytes > m_capacity - offset) {
+            ++m_failed;
+            return nullptr;
+        }
+        m_used = offset + bytes;
+        if (m_used > m_high_water) m_high_water = m_used;
+        return m_base + offset;
+    }
+
+    void reset() { m_used = 0; }
+
+    size_t used() const { return m_used; }
+    size_t capacity() const { return m_capacity; }
+    size_t high_water() const { return m_high_water; }
+    uint64_t failed() const { return m_failed; }
+
+private:
+    HugePageRegion m_storage;
+    char* m_base;
+    size_t m_capacity;
+    size_t m_used = 0;
+    size_t m_high_water = 0;
+    uint64_t m_failed = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef BAR_AGGREGATOR_H
+#define BAR_AGGREGATOR_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "sparkland/decimal.h"
+#include "sparkland/trade.h"
+
+namespace sparkland {
+
+// Bar intervals built per product, in seconds
+constexpr std::array<uint32_t, 2> DEFAULT_BAR_INTERVALS = {1, 60};
+
+// OHLCV + VWAP of all trades of one product within [start_us, start_us + interval)
+struct Bar {
+    char product_id[16];
+    uint32_t interval_s;
+    int64_t start_us;     // bucket start, microseconds since epoch (exchange time)
+    Decimal64 open;
+    Decimal64 high;
+    Decimal64 low;
+    Decimal64 close;
+    Decimal64 volume;
+    double vwap;
+    uint64_t trade_count;
+};
+
+// Builds time-bucketed bars of one product incrementally from trades.
+// A bar is completed by the first trade of a later bucket (or an explicit
+// flush); intervals without trades produce no bar. The last HISTORY completed
+// bars are kept in a fixed ring so nothing allocates after construction.
+class BarAggregator {
+public:
+    static constexpr size_t HISTORY = 64;
+
+    BarAggregator(std::string_view product_id, uint32_t interval_s)
+        : m_interval_us(static_cast<int64_t>(interval_s) * 1000000) {
+        size_t len = product_id.size() < sizeof(m_current.product_id) - 1 ? product_id.size()
+                                                                            : sizeof(m_current.product_id) - 1;
+        std::memcpy(m_current.product_id, product_id.data(), len);
+        m_current.interval_s = interval_s;
+    }
+
+    // Returns true and fills `completed` if this trade closed the open bar
+    bool add(const Trade& trade, Bar& completed) {
+        int64_t bucket = bucket_start(trade.time_us);
+        bool closed = false;
+        if (m_open && bucket > m_current.start_us) {
+            completed = close_bar();
+            closed = true;
+        }
+
+        if (!m_open) {
+            m_current.start_us = bucket;
+            m_current.open = m_current.high = m_current.low = trade.price;
+            m_current.volume = Decimal64();
+            m_current.trade_count = 0;
+            m_notional = 0.0;
+            m_open = true;
+        }
+
+        // Late trades (earlier bucket) are folded into the open bar
+        if (trade.price > m_current.high) m_current.high = trade.price;
+        if (trade.price < m_current.low) m_current.low = trade.price;
+        m_current.close = trade.price;
+        m_current.volume = m_current.volume + trade.size;
+        m_notional += trade.price.to_double() * trade.size.to_double();
+        ++m_current.trade_count;
+        return closed;
+    }
+
+    // Close the open bar once its interval has fully elapsed at now_us
+    bool flush(int64_t now_us, Bar& completed) {
+        if (!m_open || now_us < m_current.start_us + m_interval_us) return false;
+        completed = close_bar();
+        return true;
+    }
+
+    bool has_open_bar() const { return m_open; }
+
+    // Completed bars, index 0 is the most recent
+    size_t history_size() const { return m_history_count; }
+    const Bar& history(size_t index) const {
+        return m_history[(m_history_next + HISTORY - 1 - index) % HISTORY];
+    }
+
+private:
+    int64_t bucket_start(int64_t time_us) const {
+        int64_t bucket = time_us / m_interval_us;
+        if (time_us % m_interval_us < 0) --bucket;  // floor for pre-epoch times
+        return bucket * m_interval_us;
+    }
+
+    const Bar& close_bar() {
+        double volume = m_current.volume.to_double();
+        m_current.vwap = volume > 0.0 ? m_notional / volume : m_current.close.to_double();
+        m_open = false;
+
+        Bar& stored = m_history[m_history_next];
+        stored = m_current;
+        m_history_next = (m_history_next + 1) % HISTORY;
+        if (m_history_count < HISTORY) ++m_history_count;
+        return stored;
+    }
+
+    int64_t m_interval_us;
+    Bar m_current{};
+    double m_notional = 0.0;
+    bool m_open = false;
+    std::array<Bar, HISTORY> m_history;
+    size_t m_history_next = 0;
+    size_t m_history_count = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef BROADCAST_RING_H
+#define BROADCAST_RING_H
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "sparkland/huge_pages.h"
+
+namespace sparkland {
+
+// What the producer does about a consumer that falls a full ring behind
+enum class LagPolicy {
+    Block,  // producer gates on this consumer (acquire_free_slot returns nullptr)
+    Drop    // producer overwrites, the consumer skips ahead and counts the loss
+};
+
+// Single producer, multi consumer broadcast ring (disruptor style).
+// Every consumer owns a cursor and reads each published slot in place,
+// so adding a sink costs one cursor instead of another copy of every tick.
+// Producer API matches RingBuffer, each Consumer exposes RingBuffer's consumer API.
+// Capacity is the default size, a different power of two can be chosen at runtime.
+template <typename T, size_t Capacity>
+class BroadcastRing {
+    static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr size_t MAX_CONSUMERS = 8;
+
+    class Consumer {
+    public:
+        Consumer() = default;
+
+        // Delete copy/move operations, the ring keeps pointers to its consumers
+        Consumer(const Consumer&) = delete;
+        Consumer& operator=(const Consumer&) = delete;
+
+        // Try to get reference to next filled slot
+        T* acquire_filled_slot() {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            uint64_t published = m_ring->m_published.load(std::memory_order_acquire);
+            if (head == published) {
+                return nullptr;
+            }
+
+            // Lapped by the producer: resume from the newest tick
+            if (m_policy == LagPolicy::Drop && published - head > m_ring->m_capacity) {
+                m_dropped.fetch_add(published - 1 - head, std::memory_order_relaxed);
+                head = published - 1;
+                m_head.store(head, std::memory_order_release);
+            }
+            return &m_ring->m_buffer[head & m_ring->m_mask];
+        }
+
+        // Release after reading slot
+        // Returns false if a Drop consumer's slot was overwritten while it was read
+        bool release_slot() {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            bool intact = true;
+            if (m_policy == LagPolicy::Drop) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                intact = m_ring->m_claimed.load(std::memory_order_relaxed) <= head + m_ring->m_capacity;
+                if (!intact) m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            m_head.store(head + 1, std::memory_order_release);
+            return intact;
+        }
+
+        bool empty() const {
+            return m_head.load(std::memory_order_acquire) == m_ring->m_published.load(std::memory_order_acquire);
+        }
+
+        // The producer closed the ring and this consumer read every slot before the marker
+        bool drained() const {
+            return m_ring->m_closed.load(std::memory_order_acquire) && empty();
+        }
+
+        size_t size() const {
+            uint64_t published = m_ring->m_published.load(std::memory_order_acquire);
+            uint64_t lag = published - m_head.load(std::memory_order_acquire);
+            return lag > m_ring->m_capacity ? m_ring->m_capacity : static_cast<size_t>(lag);
+        }
+
+        // Ticks this consumer never saw because it lagged (Drop policy only)
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        friend class BroadcastRing;
+
+        alignas(64) std::atomic<uint64_t> m_head{0};  // Next sequence to read
+        std::atomic<uint64_t> m_dropped{0};
+        BroadcastRing* m_ring = nullptr;
+        LagPolicy m_policy = LagPolicy::Block;
+    };
+
+    // Slots live in a huge page region, preferably on numa_node when given
+    explicit BroadcastRing(size_t capacity = Capacity, int numa_node = -1)
+        : m_capacity(checked_capacity(capacity)), m_mask(capacity - 1),
+          m_storage(sizeof(T) * capacity, numa_node), m_buffer(construct_array<T>(m_storage, capacity)) {}
+    ~BroadcastRing() { destroy_array(m_buffer, m_capacity); }
+
+    // Delete copy/move operations
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+    BroadcastRing(BroadcastRing&&) = delete;
+    BroadcastRing& operator=(BroadcastRing&&) = delete;
+
+    // Register a consumer, must happen before the producer starts publishing
+    // The consumer starts at the current end of the stream
+    Consumer& add_consumer(LagPolicy policy = LagPolicy::Block) {
+        if (m_consumer_count == MAX_CONSUMERS) {
+            throw std::runtime_error("BroadcastRing: too many consumers");
+        }
+        Consumer& consumer = m_consumers[m_consumer_count++];
+        consumer.m_ring = this;
+        consumer.m_policy = policy;
+        consumer.m_head.store(m_published.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (policy == LagPolicy::Block) {
+            m_gating[m_gating_count++] = &consumer;
+        }
+        return consumer;
+    }
+
+    // Get reference to next slot to fill, nullptr if the slowest gating consumer is a ring behind
+    // ahead > 0 reaches past slots already filled but not published yet (batch publishing)
+    T* acquire_free_slot(size_t ahead = 0) {
+        uint64_t published = m_published.load(std::memory_order_relaxed);
+        uint64_t tail = published + ahead;
+        if (tail - m_cached_gate >= m_capacity) {
+            m_cached_gate = min_gating_head(published);
+            if (tail - m_cached_gate >= m_capacity) {
+                return nullptr;
+            }
+        }
+
+        // Announce the overwrite before touching the slot so Drop consumers can detect it
+        if (m_gating_count != m_consumer_count) {
+            m_claimed.store(tail + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        return &m_buffer[tail & m_mask];
+    }
+
+    // Publish after filling slot
+    void publish_slot() {
+        publish_slots(1);
+    }
+
+    // Publish count filled slots at once, consumers see the whole batch together
+    void publish_slots(size_t count) {
+        uint64_t tail = m_published.load(std::memory_order_relaxed);
+        m_published.store(tail + count, std::memory_order_release);
+    }
+
+    // End of stream marker: the producer publishes nothing after this, consumers drain up to it
+    void close() {
+        m_closed.store(true, std::memory_order_release);
+    }
+
+    bool full() const {
+        uint64_t tail = m_published.load(std::memory_order_relaxed);
+        return tail - min_gating_head(tail) >= m_capacity;
+    }
+
+    size_t capacity() const {
+        return m_capacity;
+    }
+
+    size_t consumer_count() const { return m_consumer_count; }
+
+    // Slot storage, used to prefault the ring before the feed starts
+    void* storage() { return m_buffer; }
+    size_t storage_bytes() const { return m_capacity * sizeof(T); }
+    const HugePageRegion& memory() const { return m_storage; }
+
+private:
+    static size_t checked_capacity(size_t capacity) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("BroadcastRing: capacity must be a power of two");
+        }
+        return capacity;
+    }
+
+    uint64_t min_gating_head(uint64_t tail) const {
+        uint64_t min_head = tail;
+        for (size_t i = 0; i < m_gating_count; ++i) {
+            uint64_t head = m_gating[i]->m_head.load(std::memory_order_acquire);
+            if (head < min_head) min_head = head;
+        }
+        return min_head;
+    }
+
+    alignas(64) std::atomic<uint64_t> m_published{0};  // Sequences [0, published) are readable
+    std::atomic<uint64_t> m_claimed{0};                 // Sequences [0, claimed) have been written to
+    std::atomic<bool> m_closed{false};                  // End of stream published after the last sequence
+    uint64_t m_cached_gate = 0;                         // Producer-local copy of the slowest gating cursor
+    size_t m_consumer_count = 0;
+    size_t m_gating_count = 0;
+    std::array<Consumer*, MAX_CONSUMERS> m_gating{};
+    std::array<Consumer, MAX_CONSUMERS> m_consumers;
+    const size_t m_capacity;
+    const uint64_t m_mask;
+    HugePageRegion m_storage;
+    T* m_buffer;                                        // Preallocated slots in m_storage
+};
+
+}
+
+#endif
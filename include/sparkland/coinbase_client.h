@@ -5,28 +5,117 @@
 #include <websocketpp/client.hpp>
 #include <simdjson.h>
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <thread>
 #include <atomic>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "sparkland/arena.h"
+#include "sparkland/feed_latency.h"
 #include "sparkland/logger.h"
+#include "sparkland/message_pool.h"
+#include "sparkland/thread_placement.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
 
 
 namespace sparkland{
 
 using ContextPtr = websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context>;
-using AsioClient = websocketpp::client<websocketpp::config::asio_tls_client>;
+
+// asio_tls_client with recycled message buffers (see message_pool.h)
+struct PooledTlsClientConfig : public websocketpp::config::asio_tls_client {
+    using type = PooledTlsClientConfig;
+    using message_type = websocketpp::message_buffer::message<RecyclingMessageManager>;
+    using con_msg_manager_type = RecyclingMessageManager<message_type>;
+    using endpoint_msg_manager_type = RecyclingEndpointMessageManager<con_msg_manager_type>;
+    static constexpr bool secure = true;
+};
+
+// Plain ws:// counterpart, e.g. for a local feed simulator
+struct PooledClientConfig : public websocketpp::config::asio_client {
+    using type = PooledClientConfig;
+    using message_type = websocketpp::message_buffer::message<RecyclingMessageManager>;
+    using con_msg_manager_type = RecyclingMessageManager<message_type>;
+    using endpoint_msg_manager_type = RecyclingEndpointMessageManager<con_msg_manager_type>;
+    static constexpr bool secure = false;
+};
+
+using AsioClient = websocketpp::client<PooledTlsClientConfig>;
+
+// Whether uri needs the TLS client config (wss://) or the plain one (ws://)
+inline bool is_secure_uri(const std::string& uri) { return uri.rfind("wss://", 0) == 0; }
+
+// Type erased handler, convenient but an indirect call per message
 using MessageHandler = std::function<void(simdjson::padded_string_view)>;
 
-class CoinbaseClient {
+// Feeds every message straight into a tick parser, the call is resolved at compile time
+template <typename Parser>
+struct ParserHandler {
+    Parser* parser = nullptr;
+    uint64_t failed = 0;  // messages the parser rejected or couldn't publish
+
+    void operator()(simdjson::padded_string_view payload) {
+        if (!parser->parse_and_push(payload)) ++failed;
+    }
+
+    // Frames that arrived in the same socket read, newline separated
+    void batch(simdjson::padded_string_view payloads) {
+        failed += parser->parse_batch(payloads);
+    }
+
+    // Wall clock of the socket read the following messages came from
+    void received(int64_t now_ns) {
+        parser->set_receive_time(now_ns);
+    }
+};
+
+// Handlers with a batch(padded_string_view) member get the frames that follow the first
+// one of a socket read together, see BasicCoinbaseClient::on_message
+template <typename Handler, typename = void>
+struct supports_batch : std::false_type {};
+
+template <typename Handler>
+struct supports_batch<Handler, std::void_t<decltype(std::declval<Handler&>().batch(
+                                   std::declval<simdjson::padded_string_view>()))>> : std::true_type {};
+
+// Handlers with a received(int64_t) member are told the wall clock of every socket read
+template <typename Handler, typename = void>
+struct supports_receive_time : std::false_type {};
+
+template <typename Handler>
+struct supports_receive_time<Handler, std::void_t<decltype(std::declval<Handler&>().received(int64_t{}))>>
+    : std::true_type {};
+
+using BroadcastParserHandler = ParserHandler<BroadcastTickParser>;
+using SlimBroadcastParserHandler = ParserHandler<SlimBroadcastTickParser>;
+
+// Largest payload copied into the scratch arena, bigger ones fall back to a heap copy
+constexpr size_t MESSAGE_SCRATCH_BYTES = 4 * 1024 * 1024;
+
+// Initial capacity of the batch buffer, it grows to the largest burst seen
+constexpr size_t MESSAGE_BATCH_RESERVE = 256 * 1024;
+
+// Handler is any callable taking simdjson::padded_string_view, stored by value and
+// called directly from on_message so it can be inlined into the I/O loop.
+// Config is PooledTlsClientConfig for wss:// URIs or PooledClientConfig for ws:// ones
+template <typename Handler, typename Config = PooledTlsClientConfig>
+class BasicCoinbaseClient {
 public:
-    CoinbaseClient(const std::string& uri, const std::vector<std::string>& product_ids);
-    ~CoinbaseClient();
+    using Client = websocketpp::client<Config>;
+
+    // channels e.g. "ticker", "level2_batch", "level2"
+    BasicCoinbaseClient(const std::string& uri, const std::vector<std::string>& product_ids,
+                        const std::vector<std::string>& channels = {"ticker"}, Handler handler = Handler());
+    ~BasicCoinbaseClient();
 
     // Delete copy constructor and assignment operator
-    CoinbaseClient(const CoinbaseClient&) = delete;
-    CoinbaseClient& operator=(const CoinbaseClient&) = delete;
+    BasicCoinbaseClient(const BasicCoinbaseClient&) = delete;
+    BasicCoinbaseClient& operator=(const BasicCoinbaseClient&) = delete;
 
     // Start connection and event loop in a background thread
     void start();
@@ -34,29 +123,57 @@ public:
     // Stop connection and event loop
     void stop();
 
-    void set_message_handler(MessageHandler handler);
+    // Must be called before start()
+    void set_message_handler(Handler handler);
+    Handler& handler() { return m_handler; }
+
+    // Placement of the I/O thread (which also runs the message handler), must be called before start()
+    void set_thread_placement(ThreadPlacement placement) { m_placement = std::move(placement); }
+
     bool is_connected() const;
 
 private:
     void on_open(websocketpp::connection_hdl hdl);
-    void on_message(websocketpp::connection_hdl hdl, AsioClient::message_ptr msg);
+    void on_message(websocketpp::connection_hdl hdl, typename Client::message_ptr msg);
     void on_fail(websocketpp::connection_hdl hdl);
     void on_close(websocketpp::connection_hdl hdl);
 
+    bool has_handler() const {
+        if constexpr (std::is_constructible_v<bool, const Handler&>) {
+            return static_cast<bool>(m_handler);
+        } else {
+            return true;
+        }
+    }
+
+    void flush_batch();
     void send_subscribe();
     ContextPtr on_tls_init(websocketpp::connection_hdl);
 
     std::string m_uri;
     std::vector<std::string> m_product_ids;
-    MessageHandler m_handler;
-    AsioClient m_client;
+    std::vector<std::string> m_channels;
+    Handler m_handler;
+    Client m_client;
     websocketpp::connection_hdl m_hdl;
     std::thread m_thread;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_connected{false};
+    Arena m_scratch{MESSAGE_SCRATCH_BYTES};  // padded copy of payloads that lack the padding
+    std::string m_batch;                     // frames waiting for flush_batch()
+    bool m_flush_pending = false;
+    ThreadPlacement m_placement;
     Logger& m_logger;
 };
 
+extern template class BasicCoinbaseClient<MessageHandler>;
+extern template class BasicCoinbaseClient<BroadcastParserHandler>;
+extern template class BasicCoinbaseClient<SlimBroadcastParserHandler>;
+extern template class BasicCoinbaseClient<BroadcastParserHandler, PooledClientConfig>;
+extern template class BasicCoinbaseClient<SlimBroadcastParserHandler, PooledClientConfig>;
+
+using CoinbaseClient = BasicCoinbaseClient<MessageHandler>;
+
 }
 
 #endif
@@ -0,0 +1,74 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+#include <vector>
+#include "sparkland/broadcast_ring.h"
+#include "sparkland/conflating_buffer.h"
+#include "sparkland/csv_logger.h"
+#include "sparkland/ema.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/feed_state.h"
+#include "sparkland/segmented_file.h"
+#include "sparkland/shm_bus.h"
+#include "sparkland/thread_placement.h"
+#include "sparkland/types.h"
+#include "sparkland/wait_strategy.h"
+
+namespace sparkland {
+
+// Which ticker fields are parsed and written (Tick or SlimTick, see tick_fields)
+enum class TickProfile { Full, Slim };
+
+struct SinkConfig {
+    std::string type;   // "csv" (ticks), "bars_csv", "conflated_csv" (latest tick per product) or "shm"
+    std::string path;   // file, or the shared memory name for "shm"
+    LagPolicy lag_policy = LagPolicy::Block;  // tick sinks only
+    ThreadPlacement thread;
+    OutputPolicy output;  // append by default, no rotation
+};
+
+// Everything needed to build the pipeline. Defaults match the original hard-coded setup:
+// ticker channel only, ticks.csv, no bars and no warm restart snapshots
+struct AppConfig {
+    std::string uri = "wss://ws-feed.exchange.coinbase.com";
+    std::vector<std::string> products = {"BTC-USD", "ETH-USD", "SOL-USD"};
+    std::vector<std::string> channels = {"ticker"};
+    double ema_period_s = DEFAULT_EMA_PERIOD_S;
+    TickProfile tick_profile = TickProfile::Full;
+    size_t ring_capacity = TICK_BUFFER_CAPACITY;
+    WaitStrategy wait_strategy = WaitStrategy::Sleep;
+    std::vector<SinkConfig> sinks = {
+        {"csv", "ticks.csv", LagPolicy::Block, {}, {}},
+    };
+    ThreadPlacement io_thread;  // websocket I/O + parsing
+    bool lock_memory = false;   // mlockall + prefault the rings at startup
+    double stale_feed_s = DEFAULT_STALE_FEED_S;        // product stale after this long without a tick
+    double max_feed_lag_ms = DEFAULT_MAX_FEED_LAG_MS;  // or with a larger exchange-to-local lag
+    int64_t drain_timeout_ms = DEFAULT_DRAIN_TIMEOUT.count();  // shutdown bound for the sinks to drain and sync
+    std::string snapshot_path;  // warm restart state, empty: off
+    double snapshot_interval_s = DEFAULT_SNAPSHOT_INTERVAL_S;
+    double snapshot_max_age_s = DEFAULT_SNAPSHOT_MAX_AGE_S;  // older snapshots are ignored at startup
+};
+
+// Reads the JSON config file, applies command line overrides and validates the result.
+// All errors are reported as std::invalid_argument with a readable message.
+class ConfigReader {
+public:
+    // Defaults <- --config file <- other command line options, then validate
+    static AppConfig load(int argc, char* argv[]);
+
+    // Reads a JSON config file on top of the defaults
+    static AppConfig from_file(const std::string& path);
+
+    // Applies every command line option except --config
+    static void apply_overrides(AppConfig& config, int argc, char* argv[]);
+
+    static void validate(const AppConfig& config);
+
+    static std::string usage();
+};
+
+}
+
+#endif
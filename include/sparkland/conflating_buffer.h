@@ -0,0 +1,151 @@
+#ifndef CONFLATING_BUFFER_H
+#define CONFLATING_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sparkland/seqlock.h"
+
+namespace sparkland {
+
+// Keeps only the latest value per product for consumers that want fresh data rather than
+// every update. The producer overwrites the product's slot and sets its bit in a dirty
+// bitmap; a consumer takes the bitmap and reads the dirty products in index order.
+// Updates overwritten before the consumer got to them are counted as conflated, and a
+// value is delivered once: a dirty bit for a version already read is skipped.
+// Memory is bounded by the number of products however far the consumer falls behind.
+// Single producer, single consumer.
+template <typename T>
+class ConflatingBuffer {
+public:
+    static constexpr size_t MAX_PRODUCTS = 64;  // one bitmap word
+
+    explicit ConflatingBuffer(const std::vector<std::string>& product_ids)
+        : m_product_ids(product_ids), m_slots(new Slot[product_ids.size()]) {
+        if (product_ids.size() > MAX_PRODUCTS) {
+            throw std::invalid_argument("ConflatingBuffer: at most 64 products are supported");
+        }
+    }
+
+    // Delete copy/move operations
+    ConflatingBuffer(const ConflatingBuffer&) = delete;
+    ConflatingBuffer& operator=(const ConflatingBuffer&) = delete;
+    ConflatingBuffer(ConflatingBuffer&&) = delete;
+    ConflatingBuffer& operator=(ConflatingBuffer&&) = delete;
+
+    // Returns -1 for unknown products
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_product_ids.size(); ++i) {
+            if (m_product_ids[i] == product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Producer side: replace the product's latest value and mark it dirty
+    void update(size_t index, const T& value) {
+        m_slots[index].value.store(value);
+        m_dirty.fetch_or(uint64_t{1} << index, std::memory_order_release);
+    }
+
+    // Consumer side: calls fn(index, value, conflated) for every dirty product in index order,
+    // conflated being the number of updates the value replaced. Returns the number of products read.
+    // A product updated while it is being drained is read with its newest value, once.
+    template <typename F>
+    size_t drain(F&& fn) {
+        uint64_t dirty = m_dirty.exchange(0, std::memory_order_acquire);
+        size_t count = 0;
+        T value;
+        uint64_t conflated;
+        while (dirty) {
+            size_t index = static_cast<size_t>(__builtin_ctzll(dirty));
+            dirty &= dirty - 1;
+            if (!read(index, value, conflated)) continue;
+            fn(index, value, conflated);
+            ++count;
+        }
+        return count;
+    }
+
+    bool empty() const { return m_dirty.load(std::memory_order_acquire) == 0; }
+
+    // Producer side end of stream marker, nothing is updated after this
+    void close() { m_closed.store(true, std::memory_order_release); }
+
+    // Updates that were overwritten before being read, consumer side counter
+    uint64_t conflated() const { return m_conflated; }
+
+    size_t size() const { return m_product_ids.size(); }
+    const std::string& product_id(size_t index) const { return m_product_ids[index]; }
+
+    // Source adapter with the ring consumer interface (acquire_filled_slot / release_slot / empty),
+    // so sinks written against rings can consume the conflated stream
+    class Reader {
+    public:
+        explicit Reader(ConflatingBuffer& buffer) : m_buffer(buffer) {}
+
+        T* acquire_filled_slot() {
+            uint64_t conflated;
+            for (;;) {
+                if (m_pending == 0) {
+                    m_pending = m_buffer.m_dirty.exchange(0, std::memory_order_acquire);
+                    if (m_pending == 0) return nullptr;
+                }
+                size_t index = static_cast<size_t>(__builtin_ctzll(m_pending));
+                m_pending &= m_pending - 1;
+                if (m_buffer.read(index, m_current, conflated)) return &m_current;
+            }
+        }
+
+        // The slot is a reader-local copy, nothing to hand back
+        void release_slot() {}
+
+        bool empty() const { return m_pending == 0 && m_buffer.empty(); }
+
+        // The producer closed the buffer and every product updated before that was read
+        bool drained() const { return m_buffer.m_closed.load(std::memory_order_acquire) && empty(); }
+
+        // Products waiting to be read, at most (a bit can announce a value already read)
+        size_t size() const {
+            return static_cast<size_t>(__builtin_popcountll(m_pending | m_buffer.m_dirty.load(std::memory_order_acquire)));
+        }
+
+    private:
+        ConflatingBuffer& m_buffer;
+        uint64_t m_pending = 0;  // dirty products taken but not read yet
+        T m_current{};
+    };
+
+private:
+    struct alignas(64) Slot {
+        SeqLock<T> value;           // its version counts the updates
+        uint64_t read_version = 0;  // consumer side, version last delivered
+    };
+
+    // Reads the slot and how many updates were conflated into it. Returns false if the version
+    // was already delivered: the product was updated after its bit was taken but before the
+    // read, so the previous read got the value this bit announces
+    bool read(size_t index, T& out, uint64_t& conflated) {
+        Slot& slot = m_slots[index];
+        uint64_t version;
+        out = slot.value.load(version);
+        if (version == slot.read_version) return false;
+        conflated = version - slot.read_version - 1;
+        slot.read_version = version;
+        m_conflated += conflated;
+        return true;
+    }
+
+    std::vector<std::string> m_product_ids;
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<uint64_t> m_dirty{0};
+    std::atomic<bool> m_closed{false};
+    alignas(64) uint64_t m_conflated = 0;
+};
+
+}
+
+#endif
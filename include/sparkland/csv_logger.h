@@ -1,39 +1,105 @@
 #ifndef CSV_LOGGER_H
 #define CSV_LOGGER_H
 
-#include <fstream>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <string>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include "sparkland/conflating_buffer.h"
+#include "sparkland/segmented_file.h"
 #include "sparkland/tick.h"
 #include "sparkland/types.h"
+#include "sparkland/thread_placement.h"
+#include "sparkland/wait_strategy.h"
 
 namespace sparkland {
 
-class CSVLogger {
+// How long stop() waits for a sink to reach the end of stream by default
+constexpr std::chrono::milliseconds DEFAULT_DRAIN_TIMEOUT{2000};
+
+// Outcome of stopping a sink
+struct DrainStats {
+    uint64_t written = 0;      // records written since start()
+    uint64_t abandoned = 0;    // records still unread when the deadline passed
+    uint64_t torn = 0;         // records overwritten while read (Drop consumers), not written
+    bool reached_end = false;  // everything up to the source's end of stream was written
+    bool synced = false;       // output flushed, fsynced and closed
+    double drain_ms = 0.0;     // stop() until the output was closed
+};
+
+// Source is the consumer side records are read from (TickRingBuffer, a TickBroadcastRing::Consumer
+// or BarRingBuffer). Defined in csv_logger.cpp and explicitly instantiated for each.
+// Output goes to filename, or to segments next to it when rotation is configured
+// (see SegmentedFile); existing data is appended to, never truncated.
+// The writer runs until the producer closes the source (end of stream marker), so ticks
+// published right before shutdown are never cut off.
+template <typename Source>
+class BasicCSVLogger {
+    using Record = std::remove_pointer_t<decltype(std::declval<Source&>().acquire_filled_slot())>;
+
 public:
-    CSVLogger(TickRingBuffer& ring_buffer, const std::string& filename);
-    ~CSVLogger();
+    BasicCSVLogger(Source& ring_buffer, const std::string& filename,
+                   WaitStrategy wait_strategy = WaitStrategy::Sleep,
+                   const OutputPolicy& output = OutputPolicy(),
+                   SegmentCompressor* compressor = nullptr);
+    ~BasicCSVLogger();
 
     // Delete copy/move operations
-    CSVLogger(const CSVLogger&) = delete;
-    CSVLogger& operator=(const CSVLogger&) = delete;
-    CSVLogger(CSVLogger&&) = delete;
-    CSVLogger& operator=(CSVLogger&&) = delete;
+    BasicCSVLogger(const BasicCSVLogger&) = delete;
+    BasicCSVLogger& operator=(const BasicCSVLogger&) = delete;
+    BasicCSVLogger(BasicCSVLogger&&) = delete;
+    BasicCSVLogger& operator=(BasicCSVLogger&&) = delete;
+
+    // Placement of the writer thread, must be called before start()
+    void set_thread_placement(ThreadPlacement placement) { m_placement = std::move(placement); }
 
     void start();
-    void stop();
+
+    // Waits until the writer reached the source's end of stream, then returns once the output is
+    // flushed, fsynced and closed. Past the deadline the writer stops where it is and the rest is
+    // abandoned; the fsync itself isn't interrupted. Later calls return the same stats.
+    DrainStats stop(std::chrono::steady_clock::time_point deadline);
+    DrainStats stop() { return stop(std::chrono::steady_clock::now() + DEFAULT_DRAIN_TIMEOUT); }
+
+    // Path of the file currently written, only stable while the writer isn't running
+    const std::string& current_path() const { return m_output.current_path(); }
 
 private:
     void run();
+    void start_segment();
 
-    TickRingBuffer& m_ring_buffer;
-    std::ofstream m_file;
+    Source& m_ring_buffer;
+    SegmentedFile m_output;
     std::thread m_thread;
-    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_abort{false};
+    WaitStrategy m_wait_strategy;
+    ThreadPlacement m_placement;
+
+    // Set by the writer thread once the output is closed
+    std::mutex m_mutex;
+    std::condition_variable m_finished_cv;
+    bool m_finished = false;
+    DrainStats m_stats;
 };
 
+extern template class BasicCSVLogger<TickRingBuffer>;
+extern template class BasicCSVLogger<TickBroadcastRing::Consumer>;
+extern template class BasicCSVLogger<SlimTickBroadcastRing::Consumer>;
+extern template class BasicCSVLogger<ConflatingBuffer<Tick>::Reader>;
+extern template class BasicCSVLogger<ConflatingBuffer<SlimTick>::Reader>;
+extern template class BasicCSVLogger<BarRingBuffer>;
+
+using CSVLogger = BasicCSVLogger<TickRingBuffer>;
+using BroadcastCSVLogger = BasicCSVLogger<TickBroadcastRing::Consumer>;
+using SlimBroadcastCSVLogger = BasicCSVLogger<SlimTickBroadcastRing::Consumer>;
+using ConflatedCSVLogger = BasicCSVLogger<ConflatingBuffer<Tick>::Reader>;
+using BarCSVLogger = BasicCSVLogger<BarRingBuffer>;
+
 }
 
 #endif
@@ -0,0 +1,245 @@
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string_view>
+
+namespace sparkland {
+
+// Fixed-point decimal: value = units / 10^scale
+// Coinbase quotes every price/size as a decimal string at the product's tick
+// size (quote_increment / base_increment), so keeping the scale of the wire
+// value makes parse -> format an exact round trip.
+class Decimal64 {
+public:
+    static constexpr uint8_t MAX_SCALE = 18;
+    // Sign + 19 digits + '.' + leading "0" + '\0'
+    static constexpr size_t MAX_CHARS = 24;
+
+    constexpr Decimal64() : m_units(0), m_scale(0) {}
+    constexpr Decimal64(int64_t units, uint8_t scale) : m_units(units), m_scale(scale) {}
+
+    constexpr int64_t units() const { return m_units; }
+    constexpr uint8_t scale() const { return m_scale; }
+    constexpr bool is_zero() const { return m_units == 0; }
+
+    // Parse "[-]digits[.digits]"; at most 18 significant digits
+    // Returns false (and leaves out untouched) on malformed input
+    static bool parse(std::string_view str, Decimal64& out) {
+        const char* p = str.data();
+        const char* end = p + str.size();
+        if (p == end) return false;
+
+        bool negative = false;
+        if (*p == '-') {
+            negative = true;
+            if (++p == end) return false;
+        }
+
+        // Leading zeros don't count towards the significant digit budget
+        const char* int_start = p;
+        while (p != end && *p == '0') ++p;
+        bool seen_digit = p != int_start;
+
+        uint64_t acc = 0;
+        size_t digits = parse_digits(p, end, acc);
+        seen_digit |= digits > 0;
+
+        size_t frac_digits = 0;
+        if (p != end && *p == '.') {
+            ++p;
+            frac_digits = parse_digits(p, end, acc);
+            if (frac_digits == 0) return false;
+            seen_digit = true;
+        }
+
+        if (p != end || !seen_digit) return false;
+        if (frac_digits > MAX_SCALE || digits + frac_digits > MAX_SCALE) return false;
+
+        int64_t units = static_cast<int64_t>(acc);
+        out = Decimal64(negative ? -units : units, static_cast<uint8_t>(frac_digits));
+        return true;
+    }
+
+    // Writes the exact decimal representation (no terminator), returns length
+    // `out` must hold at least MAX_CHARS bytes
+    size_t format(char* out) const {
+        char tmp[MAX_CHARS];
+        char* p = tmp + sizeof(tmp);
+
+        uint64_t u = m_units < 0 ? 0 - static_cast<uint64_t>(m_units) : static_cast<uint64_t>(m_units);
+        size_t digits = 0;
+        while (u >= 100) {
+            const char* pair = &DIGIT_PAIRS[(u % 100) * 2];
+            u /= 100;
+            *--p = pair[1];
+            *--p = pair[0];
+            digits += 2;
+        }
+        if (u >= 10) {
+            *--p = DIGIT_PAIRS[u * 2 + 1];
+            *--p = DIGIT_PAIRS[u * 2];
+            digits += 2;
+        } else {
+            *--p = static_cast<char>('0' + u);
+            ++digits;
+        }
+        // Zero-pad so there is at least one integer digit
+        while (digits < static_cast<size_t>(m_scale) + 1) {
+            *--p = '0';
+            ++digits;
+        }
+
+        char* o = out;
+        if (m_units < 0) *o++ = '-';
+        size_t int_digits = digits - m_scale;
+        std::memcpy(o, p, int_digits);
+        o += int_digits;
+        if (m_scale > 0) {
+            *o++ = '.';
+            std::memcpy(o, p + int_digits, m_scale);
+            o += m_scale;
+        }
+        return static_cast<size_t>(o - out);
+    }
+
+    // Correctly rounded while |units| < 2^53, which covers every Coinbase value
+    double to_double() const {
+        return static_cast<double>(m_units) / POW10_DOUBLE[m_scale];
+    }
+
+    // Change the tick size; scaling down truncates towards zero
+    // Returns false (and leaves out untouched) if the value doesn't fit at the finer scale
+    bool rescale(uint8_t scale, Decimal64& out) const {
+        if (scale < m_scale) {
+            out = Decimal64(m_units / POW10[m_scale - scale], scale);
+            return true;
+        }
+        int64_t units;
+        if (__builtin_mul_overflow(m_units, POW10[scale - m_scale], &units)) return false;
+        out = Decimal64(units, scale);
+        return true;
+    }
+
+    // rescale() for values known to fit, saturates at the int64 range otherwise
+    Decimal64 rescaled(uint8_t scale) const {
+        Decimal64 out;
+        if (rescale(scale, out)) return out;
+        return Decimal64(m_units < 0 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max(),
+                         scale);
+    }
+
+    // Exact (a + b) / 2, using one extra digit of scale when needed. Only values that don't fit
+    // 64 bits at the finer scale lose their finest digits
+    static Decimal64 midpoint(Decimal64 a, Decimal64 b) {
+        uint8_t scale = a.m_scale > b.m_scale ? a.m_scale : b.m_scale;
+        __int128 sum = a.wide_units(scale) + b.wide_units(scale);
+        if (sum % 2 == 0 || scale == MAX_SCALE) {
+            return narrowed(sum / 2, scale);
+        }
+        return narrowed(sum * 5, static_cast<uint8_t>(scale + 1));
+    }
+
+    // Exact sum at the finer of the two scales, same limit as midpoint()
+    friend Decimal64 operator+(Decimal64 a, Decimal64 b) {
+        uint8_t scale = a.m_scale > b.m_scale ? a.m_scale : b.m_scale;
+        return narrowed(a.wide_units(scale) + b.wide_units(scale), scale);
+    }
+
+    friend bool operator==(Decimal64 a, Decimal64 b) { return compare(a, b) == 0; }
+    friend bool operator!=(Decimal64 a, Decimal64 b) { return compare(a, b) != 0; }
+    friend bool operator<(Decimal64 a, Decimal64 b)  { return compare(a, b) < 0; }
+    friend bool operator>(Decimal64 a, Decimal64 b)  { return compare(a, b) > 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, Decimal64 value) {
+        char buf[MAX_CHARS];
+        return os.write(buf, static_cast<std::streamsize>(value.format(buf)));
+    }
+
+private:
+    static int compare(Decimal64 a, Decimal64 b) {
+        uint8_t scale = a.m_scale > b.m_scale ? a.m_scale : b.m_scale;
+        __int128 lhs = a.wide_units(scale);
+        __int128 rhs = b.wide_units(scale);
+        return (lhs > rhs) - (lhs < rhs);
+    }
+
+    // Units at a scale >= m_scale in 128 bits, exact: |units| < 2^63 and 10^18 < 2^60
+    __int128 wide_units(uint8_t scale) const {
+        return static_cast<__int128>(m_units) * POW10[scale - m_scale];
+    }
+
+    // Back to 64 bits, dropping the finest digits (truncating towards zero) until the value fits
+    static Decimal64 narrowed(__int128 units, uint8_t scale) {
+        constexpr int64_t max = std::numeric_limits<int64_t>::max();
+        constexpr int64_t min = std::numeric_limits<int64_t>::min();
+        while ((units > max || units < min) && scale > 0) {
+            units /= 10;
+            --scale;
+        }
+        if (units > max) units = max;  // sums of two integers near the int64 limits
+        if (units < min) units = min;
+        return Decimal64(static_cast<int64_t>(units), scale);
+    }
+
+    // SWAR digit parsing (little-endian): validates and converts 8 ASCII digits per step
+    static bool is_eight_digits(uint64_t val) {
+        return ((val & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+    }
+
+    static uint32_t parse_eight_digits(uint64_t val) {
+        const uint64_t mask = 0x000000FF000000FFULL;
+        const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+        const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+        val -= 0x3030303030303030ULL;
+        val = (val * 10) + (val >> 8);
+        val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+        return static_cast<uint32_t>(val);
+    }
+
+    // Accumulates a run of digits into acc, returns the number consumed
+    // Overflow is harmless: callers reject runs longer than MAX_SCALE
+    static size_t parse_digits(const char*& p, const char* end, uint64_t& acc) {
+        const char* start = p;
+        while (end - p >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, sizeof(chunk));
+            if (!is_eight_digits(chunk)) break;
+            acc = acc * 100000000ULL + parse_eight_digits(chunk);
+            p += 8;
+        }
+        while (p != end && static_cast<unsigned char>(*p - '0') < 10) {
+            acc = acc * 10 + static_cast<uint64_t>(*p - '0');
+            ++p;
+        }
+        return static_cast<size_t>(p - start);
+    }
+
+    static constexpr int64_t POW10[MAX_SCALE + 1] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+        100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+        1000000000000LL, 10000000000000LL, 100000000000000LL,
+        1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL};
+
+    static constexpr double POW10_DOUBLE[MAX_SCALE + 1] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+        1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+
+    static constexpr char DIGIT_PAIRS[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    int64_t m_units;
+    uint8_t m_scale;
+};
+
+}
+
+#endif
@@ -2,10 +2,13 @@
 #define EMA_H
 
 #include <chrono>
+#include <cmath>
 #include <iostream>
 
 namespace sparkland {
 
+constexpr double DEFAULT_EMA_PERIOD_S = 5.0;
+
 class EMA {
 public:
     EMA(double time_period) : m_time_period(time_period), m_initialized(false) {}
@@ -28,6 +31,14 @@ public:
         m_last_update = tick_time;
     }
 
+    // Continues from a saved state (warm restart), last_update on this process's steady clock
+    void restore(double price_ema, double mid_ema, std::chrono::steady_clock::time_point last_update) {
+        m_price_ema = price_ema;
+        m_mid_ema = mid_ema;
+        m_last_update = last_update;
+        m_initialized = true;
+    }
+
     double price_ema() const { return m_price_ema; }
     double mid_ema()   const { return m_mid_ema; }
     bool initialized() const { return m_initialized; }
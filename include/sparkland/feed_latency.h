@@ -0,0 +1,111 @@
+#ifndef FEED_LATENCY_H
+#define FEED_LATENCY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sparkland/latency_histogram.h"
+
+namespace sparkland {
+
+constexpr double DEFAULT_STALE_FEED_S = 5.0;
+constexpr double DEFAULT_MAX_FEED_LAG_MS = 2000.0;
+
+// CLOCK_REALTIME in ns since the epoch, the clock exchange timestamps are compared against
+int64_t wall_clock_ns();
+
+// Exchange timestamp format, e.g. 2025-09-07T08:47:52.369411Z (fraction_digits 0-9)
+std::string format_exchange_time(int64_t epoch_ns, int fraction_digits = 6);
+
+// YYYY-MM-DDTHH:MM:SS[.fraction]Z to ns since the epoch, -1 if malformed.
+// Plain arithmetic, no timegm, cheap enough for every tick
+int64_t parse_exchange_time(std::string_view str);
+
+// Kernel NTP state (adjtimex, read-only). Exchange-to-local lag is only as good as the clock:
+// unsynchronized or with a large error it includes the clock offset
+struct ClockSyncStatus {
+    bool synchronized = false;
+    int64_t estimated_error_ns = 0;
+    int64_t max_error_ns = 0;
+};
+ClockSyncStatus clock_sync_status();
+
+// Per-product latency of the feed, written from the parser thread:
+// - lag: exchange time of the tick to its receive time at the socket read (Coinbase + network,
+//   plus any clock offset); exchange times ahead of the local clock count as clock_skewed, lag 0
+// - stack: receive time to the parsed tick, our own part
+// A product is stale when nothing arrived for stale_after_ns or its last lag exceeded max_lag_ns,
+// which any thread may check.
+class FeedLatencyMonitor {
+public:
+    FeedLatencyMonitor(const std::vector<std::string>& product_ids, int64_t stale_after_ns, int64_t max_lag_ns);
+
+    // Delete copy/move operations
+    FeedLatencyMonitor(const FeedLatencyMonitor&) = delete;
+    FeedLatencyMonitor& operator=(const FeedLatencyMonitor&) = delete;
+    FeedLatencyMonitor(FeedLatencyMonitor&&) = delete;
+    FeedLatencyMonitor& operator=(FeedLatencyMonitor&&) = delete;
+
+    // Returns -1 for unknown products
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_size; ++i) {
+            if (m_products[i].id == product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Parser thread, exchange_ns < 0 when the tick has no exchange time
+    void record(size_t index, int64_t receive_ns, int64_t exchange_ns, int64_t parsed_ns) {
+        Product& product = m_products[index];
+        if (exchange_ns >= 0) {
+            int64_t lag = receive_ns - exchange_ns;
+            if (lag < 0) {
+                ++product.clock_skewed;
+                lag = 0;
+            }
+            product.lag.record(static_cast<uint64_t>(lag));
+            product.last_lag_ns.store(lag, std::memory_order_relaxed);
+        }
+        if (parsed_ns >= receive_ns) product.stack.record(static_cast<uint64_t>(parsed_ns - receive_ns));
+        product.last_receive_ns.store(receive_ns, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    bool stale(size_t index, int64_t now_ns) const {
+        const Product& product = m_products[index];
+        return now_ns - product.last_receive_ns.load(std::memory_order_relaxed) > m_stale_after_ns ||
+               product.last_lag_ns.load(std::memory_order_relaxed) > m_max_lag_ns;
+    }
+    int64_t last_receive_ns(size_t index) const { return m_products[index].last_receive_ns.load(std::memory_order_relaxed); }
+    int64_t last_lag_ns(size_t index) const { return m_products[index].last_lag_ns.load(std::memory_order_relaxed); }
+
+    // Parser thread, or any thread once it stopped
+    const LatencyHistogram& lag_histogram(size_t index) const { return m_products[index].lag; }
+    const LatencyHistogram& stack_histogram(size_t index) const { return m_products[index].stack; }
+    uint64_t clock_skewed(size_t index) const { return m_products[index].clock_skewed; }
+
+    size_t size() const { return m_size; }
+    const std::string& product_id(size_t index) const { return m_products[index].id; }
+
+private:
+    struct Product {
+        std::string id;
+        LatencyHistogram lag;
+        LatencyHistogram stack;
+        uint64_t clock_skewed = 0;
+        alignas(64) std::atomic<int64_t> last_receive_ns{0};
+        std::atomic<int64_t> last_lag_ns{0};
+    };
+
+    std::unique_ptr<Product[]> m_products;
+    size_t m_size;
+    int64_t m_stale_after_ns;
+    int64_t m_max_lag_ns;
+};
+
+}
+
+#endif
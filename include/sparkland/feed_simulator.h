@@ -0,0 +1,96 @@
+#ifndef FEED_SIMULATOR_H
+#define FEED_SIMULATOR_H
+
+#include <websocketpp/config/asio.hpp>
+#include <websocketpp/server.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sparkland/logger.h"
+#include "sparkland/ticker_generator.h"
+
+namespace sparkland {
+
+// Certificate chain and private key (PEM) of the TLS simulator, a self-signed pair is enough:
+// the client doesn't verify the peer
+struct TlsFiles {
+    std::string certificate_chain;
+    std::string private_key;
+};
+
+// Local websocket feed speaking enough of the Coinbase protocol for BasicCoinbaseClient:
+// answers subscribe with a subscriptions message, then streams the FeedProfile's ticker
+// messages to every subscriber. Sends are paced on the I/O thread by a timer, every burst
+// goes out back to back and a late timer catches up, so the average rate holds.
+// Config is websocketpp::config::asio (ws://) or websocketpp::config::asio_tls (wss://).
+template <typename Config>
+class BasicFeedSimulator {
+public:
+    using Server = websocketpp::server<Config>;
+
+    // tls is only used by the TLS config
+    BasicFeedSimulator(const FeedProfile& profile, uint16_t port, const TlsFiles& tls = TlsFiles());
+    ~BasicFeedSimulator();
+
+    // Delete copy/move operations
+    BasicFeedSimulator(const BasicFeedSimulator&) = delete;
+    BasicFeedSimulator& operator=(const BasicFeedSimulator&) = delete;
+    BasicFeedSimulator(BasicFeedSimulator&&) = delete;
+    BasicFeedSimulator& operator=(BasicFeedSimulator&&) = delete;
+
+    // Listen and run the I/O thread, streaming starts with the first subscriber.
+    // Throws websocketpp::exception if the port can't be bound
+    void start();
+    void stop();
+
+    const std::vector<std::string>& products() const { return m_generator.products(); }
+
+    uint64_t sent() const { return m_sent.load(std::memory_order_acquire); }
+    uint64_t send_errors() const { return m_send_errors.load(std::memory_order_relaxed); }
+    uint64_t late_bursts() const { return m_late_bursts.load(std::memory_order_relaxed); }  // timer fired after the next burst was due
+    bool finished() const { return m_finished.load(std::memory_order_acquire); }  // every message of duration_s sent
+
+private:
+    using Timer = websocketpp::lib::asio::steady_timer;
+
+    void on_message(websocketpp::connection_hdl hdl, typename Server::message_ptr msg);
+    void on_close(websocketpp::connection_hdl hdl);
+    void schedule(std::chrono::steady_clock::time_point when);
+    void send_due();
+
+    FeedProfile m_profile;
+    uint16_t m_port;
+    TlsFiles m_tls;
+    TickerGenerator m_generator;
+    uint64_t m_total;  // messages to send, 0 for no limit
+
+    Server m_server;
+    std::unique_ptr<Timer> m_timer;
+    std::set<websocketpp::connection_hdl, std::owner_less<websocketpp::connection_hdl>> m_subscribers;
+    std::chrono::steady_clock::time_point m_stream_start;
+    bool m_streaming = false;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<uint64_t> m_sent{0};
+    std::atomic<uint64_t> m_send_errors{0};
+    std::atomic<uint64_t> m_late_bursts{0};
+    std::atomic<bool> m_finished{false};
+    Logger& m_logger;
+};
+
+extern template class BasicFeedSimulator<websocketpp::config::asio>;
+extern template class BasicFeedSimulator<websocketpp::config::asio_tls>;
+
+using FeedSimulator = BasicFeedSimulator<websocketpp::config::asio>;
+using TlsFeedSimulator = BasicFeedSimulator<websocketpp::config::asio_tls>;
+
+}
+
+#endif
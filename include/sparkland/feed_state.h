@@ -0,0 +1,112 @@
+#ifndef FEED_STATE_H
+#define FEED_STATE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "sparkland/snapshot_cache.h"
+
+namespace sparkland {
+
+// Bumped whenever ProductState or the file header change, older files are ignored
+constexpr uint32_t FEED_STATE_VERSION = 1;
+
+constexpr double DEFAULT_SNAPSHOT_INTERVAL_S = 1.0;
+constexpr double DEFAULT_SNAPSHOT_MAX_AGE_S = 60.0;
+
+// What a product needs to come back warm after a restart
+struct ProductState {
+    char product_id[16];
+    TopOfBook top;              // last top-of-book, ticker EMAs and sequence
+    int64_t ema_update_ns = 0;  // wall clock of the last EMA update, 0: the EMA never saw a tick
+};
+
+struct FeedState {
+    int64_t written_ns = 0;  // wall clock the snapshot was taken at
+    double ema_period_s = 0.0;
+    std::vector<ProductState> products;
+};
+
+// Writes the state to path atomically: temporary file, fsync, rename, fsync of the directory.
+// A crash leaves either the previous snapshot or the new one, never a partial file
+bool write_feed_state(const std::string& path, const FeedState& state);
+
+// Reads a snapshot written by write_feed_state. Returns false with the reason in error if the
+// file is missing, truncated, corrupt (checksum), of another version or EMA period, or older
+// than max_age_ns at now_ns
+bool read_feed_state(const std::string& path, double ema_period_s, int64_t now_ns, int64_t max_age_ns,
+                     FeedState& out, std::string& error);
+
+// Periodic snapshots of the parser's per-product state, written off the hot path.
+// The parser updates its staged copy in place on every tick; once an interval has passed
+// it copies the staged state into the writer's buffer, unless the writer is still busy with
+// the previous snapshot (that snapshot is skipped, the parser never waits). The writer thread
+// then writes the file while the parser keeps working on its own copy.
+class FeedStateSnapshotter {
+public:
+    FeedStateSnapshotter(std::string path, const std::vector<std::string>& product_ids, double ema_period_s,
+                         int64_t interval_ns);
+    ~FeedStateSnapshotter();
+
+    // Delete copy/move operations
+    FeedStateSnapshotter(const FeedStateSnapshotter&) = delete;
+    FeedStateSnapshotter& operator=(const FeedStateSnapshotter&) = delete;
+    FeedStateSnapshotter(FeedStateSnapshotter&&) = delete;
+    FeedStateSnapshotter& operator=(FeedStateSnapshotter&&) = delete;
+
+    // Returns -1 for unknown products
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_staged.size(); ++i) {
+            if (product_id == m_staged[i].product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Parser thread: the product's state for the next snapshot
+    ProductState& stage(size_t index) { return m_staged[index]; }
+
+    // Parser thread, after staging: hands a copy to the writer once the interval elapsed
+    void maybe_snapshot(int64_t now_ns) {
+        if (now_ns >= m_next_ns) offer(now_ns);
+    }
+
+    void start();
+
+    // Writes the staged state one last time and stops the writer, call once the parser stopped
+    void stop();
+
+    size_t size() const { return m_staged.size(); }
+    const std::string& path() const { return m_path; }
+
+    uint64_t written() const { return m_written; }  // snapshots on disk, only stable after stop()
+    uint64_t failed() const { return m_failed; }
+    uint64_t skipped() const { return m_skipped; }  // parser thread: writer was still busy
+
+private:
+    void offer(int64_t now_ns);
+    void run();
+
+    std::string m_path;
+    int64_t m_interval_ns;
+    int64_t m_next_ns = 0;
+    uint64_t m_skipped = 0;
+    std::vector<ProductState> m_staged;  // parser thread
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    FeedState m_pending;       // writer's copy, guarded by m_mutex unless m_writing
+    bool m_has_pending = false;
+    bool m_writing = false;
+    bool m_stopping = false;
+    uint64_t m_written = 0;
+    uint64_t m_failed = 0;
+    std::thread m_thread;
+};
+
+}
+
+#endif
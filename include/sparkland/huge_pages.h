@@ -0,0 +1,83 @@
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace sparkland {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Smaller requests aren't worth a huge page and use plain pages
+constexpr size_t HUGE_PAGE_THRESHOLD = HUGE_PAGE_SIZE / 2;
+
+// How a region ended up backed
+enum class PageBacking {
+    HugeTlb,          // explicit 2 MB pages from the hugetlbfs pool (vm.nr_hugepages)
+    TransparentHuge,  // 2 MB aligned with MADV_HUGEPAGE, the kernel promotes it when it can
+    Regular           // 4 KB pages
+};
+
+const char* to_string(PageBacking backing);
+
+// Anonymous memory mapping for rings and other large pre-allocated pools.
+// Tries explicit huge pages first and falls back to transparent huge pages, then to regular pages.
+// With numa_node >= 0 the pages are preferably allocated on that node (mbind, MPOL_PREFERRED),
+// which takes effect because nothing has touched them yet.
+// The memory is zero filled and released on destruction.
+class HugePageRegion {
+public:
+    explicit HugePageRegion(size_t bytes, int numa_node = -1);
+    ~HugePageRegion();
+
+    // Delete copy/move operations
+    HugePageRegion(const HugePageRegion&) = delete;
+    HugePageRegion& operator=(const HugePageRegion&) = delete;
+    HugePageRegion(HugePageRegion&&) = delete;
+    HugePageRegion& operator=(HugePageRegion&&) = delete;
+
+    void* data() const { return m_data; }
+    size_t size() const { return m_size; }         // requested size
+    size_t mapped_size() const { return m_mapped; } // rounded up to the page size
+    PageBacking backing() const { return m_backing; }
+    int numa_node() const { return m_numa_node; }   // -1 if no policy was applied
+
+private:
+    void* m_data = nullptr;
+    void* m_mapping = nullptr;
+    size_t m_size = 0;
+    size_t m_mapped = 0;
+    size_t m_mapping_size = 0;
+    PageBacking m_backing = PageBacking::Regular;
+    int m_numa_node = -1;
+};
+
+// Default-construct count objects of T at the start of region, which must be large enough
+template <typename T>
+T* construct_array(HugePageRegion& region, size_t count) {
+    T* items = static_cast<T*>(region.data());
+    for (size_t i = 0; i < count; ++i) {
+        new (items + i) T();
+    }
+    return items;
+}
+
+template <typename T>
+void destroy_array(T* items, size_t count) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i < count; ++i) {
+            items[i].~T();
+        }
+    }
+}
+
+// NUMA node of a CPU from sysfs, -1 if unknown (or not a NUMA system)
+int numa_node_of_cpu(int cpu);
+
+// NUMA node the calling thread is running on, -1 if unknown
+int current_numa_node();
+
+}
+
+#endif
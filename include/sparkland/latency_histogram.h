@@ -0,0 +1,88 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+namespace sparkland {
+
+// Fixed size log-linear histogram of non-negative values (e.g. latencies in ns). Values below
+// LINEAR are exact, above that every power of two is split into SUB_BUCKETS buckets, so a
+// percentile is within 1/SUB_BUCKETS (~3%) of the true value. Recording never allocates.
+// Owned by one thread, merge() histograms of several threads for a report.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr uint64_t LINEAR = SUB_BUCKETS * 2;
+    static constexpr size_t BUCKETS = LINEAR + (63 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        ++m_counts[index_of(value)];
+        ++m_count;
+        m_sum += value;
+        if (value > m_max) m_max = value;
+        if (m_count == 1 || value < m_min) m_min = value;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.m_count == 0) return;
+        for (size_t i = 0; i < BUCKETS; ++i) m_counts[i] += other.m_counts[i];
+        if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+        if (other.m_max > m_max) m_max = other.m_max;
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+    }
+
+    void reset() { *this = LatencyHistogram(); }
+
+    // Upper bound of the bucket holding the q quantile (0 <= q <= 1), capped at max(); 0 if empty
+    uint64_t percentile(double q) const {
+        if (m_count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(m_count) + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > m_count) rank = m_count;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                uint64_t upper = upper_bound(i);
+                return upper < m_max ? upper : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    uint64_t count() const { return m_count; }
+    uint64_t min() const { return m_min; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0; }
+
+private:
+    static size_t index_of(uint64_t value) {
+        if (value < LINEAR) return static_cast<size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        uint64_t sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return static_cast<size_t>(LINEAR + (msb - SUB_BUCKET_BITS - 1) * SUB_BUCKETS + sub);
+    }
+
+    static uint64_t upper_bound(size_t index) {
+        if (index < LINEAR) return index;
+        uint64_t offset = index - LINEAR;
+        int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+        uint64_t sub = offset % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+    std::array<uint64_t, BUCKETS> m_counts{};
+    uint64_t m_count = 0;
+    uint64_t m_sum = 0;
+    uint64_t m_min = 0;
+    uint64_t m_max = 0;
+};
+
+}
+
+#endif
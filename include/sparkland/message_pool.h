@@ -0,0 +1,104 @@
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include <websocketpp/common/memory.hpp>
+#include <websocketpp/frame.hpp>
+#include <simdjson.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sparkland {
+
+constexpr size_t MESSAGE_POOL_SIZE = 16;
+
+// Drop-in for websocketpp's message_buffer::alloc::con_msg_manager that recycles messages.
+// The default manager make_shared()s a message and reserves a fresh payload per frame; this
+// one hands out a pooled message once the connection and the handler have let go of it
+// (only the pool still holds a reference), keeping the payload capacity of earlier frames.
+// Payloads reserve SIMDJSON_PADDING extra bytes so they can be parsed in place.
+// A connection's manager is only used from its I/O thread.
+template <typename message>
+class RecyclingMessageManager : public websocketpp::lib::enable_shared_from_this<RecyclingMessageManager<message>> {
+public:
+    using type = RecyclingMessageManager<message>;
+    using ptr = websocketpp::lib::shared_ptr<type>;
+    using weak_ptr = websocketpp::lib::weak_ptr<type>;
+    using message_ptr = typename message::ptr;
+
+    RecyclingMessageManager() { m_pool.reserve(MESSAGE_POOL_SIZE); }
+
+    message_ptr get_message() {
+        return get_message(websocketpp::frame::opcode::text, 0);
+    }
+
+    message_ptr get_message(websocketpp::frame::opcode::value op, size_t size) {
+        for (auto& pooled : m_pool) {
+            if (pooled.use_count() == 1) {
+                reset(*pooled, op, size);
+                ++m_reused;
+                return pooled;
+            }
+        }
+
+        // Pool exhausted (or still warming up), allocate
+        ++m_allocated;
+        message_ptr msg = websocketpp::lib::make_shared<message>(type::shared_from_this(), op,
+                                                                 size + simdjson::SIMDJSON_PADDING);
+        if (m_pool.size() < MESSAGE_POOL_SIZE) {
+            m_pool.push_back(msg);
+        }
+        return msg;
+    }
+
+    // Pooled messages come back through their reference count instead
+    bool recycle(message*) { return false; }
+
+    uint64_t reused() const { return m_reused; }
+    uint64_t allocated() const { return m_allocated; }
+
+private:
+    static void reset(message& msg, websocketpp::frame::opcode::value op, size_t size) {
+        msg.set_opcode(op);
+        msg.set_prepared(false);
+        msg.set_fin(true);
+        msg.set_terminal(false);
+        msg.set_compressed(false);
+        msg.set_header(std::string());
+
+        // clear() keeps the capacity, reserve only ever grows it
+        std::string& payload = msg.get_raw_payload();
+        payload.clear();
+        if (payload.capacity() < size + simdjson::SIMDJSON_PADDING) {
+            payload.reserve(size + simdjson::SIMDJSON_PADDING);
+        }
+    }
+
+    std::vector<message_ptr> m_pool;
+    uint64_t m_reused = 0;
+    uint64_t m_allocated = 0;
+};
+
+// Matching endpoint_msg_manager, one recycling manager per connection
+template <typename con_msg_manager>
+class RecyclingEndpointMessageManager {
+public:
+    using con_msg_man_ptr = typename con_msg_manager::ptr;
+
+    con_msg_man_ptr get_manager() const {
+        return websocketpp::lib::make_shared<con_msg_manager>();
+    }
+};
+
+// View of payload with simdjson's padding if its spare capacity covers it
+inline bool padded_view(std::string& payload, simdjson::padded_string_view& view) {
+    if (payload.capacity() - payload.size() < simdjson::SIMDJSON_PADDING) return false;
+    view = simdjson::padded_string_view(payload.data(), payload.size(), payload.capacity());
+    return true;
+}
+
+}
+
+#endif
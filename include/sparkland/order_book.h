@@ -0,0 +1,86 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "sparkland/decimal.h"
+
+namespace sparkland {
+
+enum class Side : uint8_t {
+    Buy,
+    Sell
+};
+
+struct PriceLevel {
+    int64_t price;   // In ticks of the book's price scale
+    Decimal64 size;
+};
+
+// Level-2 book of one product.
+// Each side is a flat, sorted vector ordered worst -> best, so the touch lives
+// at the back: the common updates (near the touch) are found with a short
+// linear scan and inserted/erased with a small memmove, and the whole side is
+// contiguous for the depth-weighted calculations. Snapshots are staged aside and
+// swapped in whole, so a snapshot never goes through the per-level path.
+class OrderBook {
+public:
+    // Coinbase never quotes more than 8 decimals, so the default scale fits any product
+    static constexpr uint8_t DEFAULT_PRICE_SCALE = 8;
+    static constexpr size_t DEFAULT_RESERVED_LEVELS = 1024;
+    static constexpr size_t DEFAULT_WEIGHTED_DEPTH = 5;
+
+    explicit OrderBook(uint8_t price_scale = DEFAULT_PRICE_SCALE,
+                       size_t reserved_levels = DEFAULT_RESERVED_LEVELS);
+
+    // Drop all levels
+    void clear();
+
+    // Set the aggregate size at a price level, zero size removes the level
+    // Returns false (book unchanged) if the price is too large for the book's price scale
+    bool apply(Side side, Decimal64 price, Decimal64 size);
+
+    // Snapshot: begin, stage every level, commit. The book is untouched until the commit, so a
+    // snapshot that fails half way leaves it as it was (the next begin drops the staged levels).
+    // Levels are expected best first as Coinbase sends them, other orders are sorted once
+    void begin_snapshot();
+    bool stage_level(Side side, Decimal64 price, Decimal64 size);  // false like apply()
+    void commit_snapshot();
+
+    size_t depth(Side side) const { return side == Side::Buy ? m_bids.size() : m_asks.size(); }
+
+    // index 0 is the touch, index must be < depth(side)
+    const PriceLevel& level(Side side, size_t index) const {
+        const auto& levels = side == Side::Buy ? m_bids : m_asks;
+        return levels[levels.size() - 1 - index];
+    }
+
+    Decimal64 price_of(const PriceLevel& level) const { return Decimal64(level.price, m_price_scale); }
+
+    bool has_top() const { return !m_bids.empty() && !m_asks.empty(); }
+
+    // Exact (best_bid + best_ask) / 2, zero if a side is empty
+    Decimal64 mid_price() const;
+
+    // Size weighted mid of the touch: (bid * ask_size + ask * bid_size) / (bid_size + ask_size)
+    double microprice() const { return weighted_mid(1); }
+
+    // Microprice generalised to the VWAP of the best `levels` levels of each side
+    double weighted_mid(size_t levels) const;
+
+    uint64_t updates() const { return m_updates; }
+    uint8_t price_scale() const { return m_price_scale; }
+
+private:
+    uint8_t m_price_scale;
+    uint64_t m_updates = 0;
+    std::vector<PriceLevel> m_bids;  // Ascending, best bid at back
+    std::vector<PriceLevel> m_asks;  // Descending, best ask at back
+    std::vector<PriceLevel> m_staged_bids;  // Snapshot being built, best first
+    std::vector<PriceLevel> m_staged_asks;
+};
+
+}
+
+#endif
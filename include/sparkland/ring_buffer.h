@@ -2,8 +2,8 @@
 #define RING_BUFFER_H
 
 #include <atomic>
-#include <array>
 #include <cstddef>
+#include "sparkland/huge_pages.h"
 
 namespace sparkland {
 
@@ -12,8 +12,10 @@ class RingBuffer {
     static_assert(Capacity > 1, "Capacity must be greater than 1");
 
 public:
-    RingBuffer() = default;
-    ~RingBuffer() = default;
+    // Slots live in a huge page region, preferably on numa_node when given
+    explicit RingBuffer(int numa_node = -1)
+        : m_storage(sizeof(T) * Capacity, numa_node), m_buffer(construct_array<T>(m_storage, Capacity)) {}
+    ~RingBuffer() { destroy_array(m_buffer, Capacity); }
 
     // Delete copy/move operations
     RingBuffer(const RingBuffer&) = delete;
@@ -22,22 +24,28 @@ public:
     RingBuffer& operator=(RingBuffer&&) = delete;
 
     // Get reference to next slot to fill
-    T* acquire_free_slot() {
+    // ahead > 0 reaches past slots already filled but not published yet (batch publishing)
+    T* acquire_free_slot(size_t ahead = 0) {
         size_t current_tail = m_tail.load(std::memory_order_relaxed);
-        size_t next_tail = (current_tail + 1) % Capacity;
+        size_t used = (current_tail + Capacity - m_head.load(std::memory_order_acquire)) % Capacity;
 
         // Check if buffer is full
-        if (next_tail == m_head.load(std::memory_order_acquire)) {
+        if (used + ahead + 1 >= Capacity) {
             return nullptr;
         }
 
-        return &m_buffer[current_tail];
+        return &m_buffer[(current_tail + ahead) % Capacity];
     }
 
     // Publish after filling slot
     void publish_slot() {
+        publish_slots(1);
+    }
+
+    // Publish count filled slots at once
+    void publish_slots(size_t count) {
         size_t current_tail = m_tail.load(std::memory_order_relaxed);
-        size_t next_tail = (current_tail + 1) % Capacity;
+        size_t next_tail = (current_tail + count) % Capacity;
         m_tail.store(next_tail, std::memory_order_release);
     }
 
@@ -64,6 +72,16 @@ public:
         return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
     }
 
+    // End of stream marker: the producer publishes nothing after this
+    void close() {
+        m_closed.store(true, std::memory_order_release);
+    }
+
+    // The producer closed the ring and every slot before the marker was read
+    bool drained() const {
+        return m_closed.load(std::memory_order_acquire) && empty();
+    }
+
     bool full() const {
         size_t next_tail = (m_tail.load(std::memory_order_relaxed) + 1) % Capacity;
         return next_tail == m_head.load(std::memory_order_acquire);
@@ -84,10 +102,17 @@ public:
         return Capacity - 1; // one slot always unused
     }
 
+    // Slot storage, used to prefault the ring before the feed starts
+    void* storage() { return m_buffer; }
+    constexpr size_t storage_bytes() const { return sizeof(T) * Capacity; }
+    const HugePageRegion& memory() const { return m_storage; }
+
 private:
     alignas(64) std::atomic<size_t> m_head{0};  // Pop index
     alignas(64) std::atomic<size_t> m_tail{0};  // Push index
-    std::array<T, Capacity> m_buffer;           // Preallocated slots
+    std::atomic<bool> m_closed{false};          // End of stream published
+    HugePageRegion m_storage;
+    T* m_buffer;                                // Preallocated slots in m_storage
 };
 
 }
@@ -0,0 +1,157 @@
+#ifndef SEGMENTED_FILE_H
+#define SEGMENTED_FILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include "sparkland/uring_file.h"
+
+namespace sparkland {
+
+// What happens to existing output when a sink starts, data is never truncated
+enum class OpenMode {
+    Append,     // continue the latest segment (or the plain file)
+    NewSegment  // always start a new segment next to the existing ones
+};
+
+// How rows reach the disk
+enum class FileWriter {
+    Stream,  // std::filebuf, write(2) on the writer thread
+    IoUring  // UringFileBuf, asynchronous writes from registered buffers
+};
+
+// How a sink writes its output file
+struct OutputPolicy {
+    OpenMode open_mode = OpenMode::Append;
+    FileWriter writer = FileWriter::Stream;
+    bool direct_io = false;   // O_DIRECT, io_uring writer only
+    uint64_t max_bytes = 0;   // start a new segment past this size, 0: no size limit
+    uint32_t interval_s = 0;  // start a new segment every interval (aligned to UTC), 0: no time limit
+    bool compress = false;    // gzip closed segments in the background
+
+    // The file is split into segments rather than written to the configured path
+    bool segmented() const { return open_mode == OpenMode::NewSegment || max_bytes > 0 || interval_s > 0; }
+};
+
+// Size is checked every this many records
+constexpr uint32_t ROTATION_CHECK_RECORDS = 1024;
+
+// Segment name for base path "dir/ticks.csv":
+//   dir/ticks.20251018T140000Z.0003.csv  with time based rotation (start of the period, UTC)
+//   dir/ticks.0003.csv                   otherwise
+// Names sort in write order and are the same for the same period and index on every run.
+std::string segment_path(const std::string& base, uint32_t interval_s, std::time_t period_start, uint32_t index);
+
+// gzips path into path.gz (through a temporary, so a .gz is always complete) and removes path
+bool gzip_file(const std::string& path);
+
+// Compresses closed segments on a background thread running at idle CPU and I/O priority,
+// so it never competes with the writers. Shared by all sinks.
+class SegmentCompressor {
+public:
+    SegmentCompressor();
+    ~SegmentCompressor();
+
+    // Delete copy/move operations
+    SegmentCompressor(const SegmentCompressor&) = delete;
+    SegmentCompressor& operator=(const SegmentCompressor&) = delete;
+    SegmentCompressor(SegmentCompressor&&) = delete;
+    SegmentCompressor& operator=(SegmentCompressor&&) = delete;
+
+    // Queue a closed file, called by the writers on rotation
+    void submit(std::string path);
+
+    // Compresses what is queued, then stops the thread
+    void stop();
+
+    uint64_t compressed() const { return m_compressed.load(std::memory_order_relaxed); }
+    uint64_t failed() const { return m_failed.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::string> m_queue;
+    bool m_stopping = false;
+    std::thread m_thread;
+    std::atomic<uint64_t> m_compressed{0};
+    std::atomic<uint64_t> m_failed{0};
+};
+
+// Output file of a sink with optional rotation. Owned by the writer thread, except for
+// construction. Segments are opened for appending, an existing segment only gets a header
+// if it is empty. The io_uring writer falls back to the stream writer if io_uring is unavailable
+// or can't write (kernel before 5.6).
+class SegmentedFile {
+public:
+    // compressor may be nullptr when policy.compress is off
+    SegmentedFile(const std::string& path, const OutputPolicy& policy, SegmentCompressor* compressor = nullptr);
+    ~SegmentedFile();
+
+    // Delete copy/move operations
+    SegmentedFile(const SegmentedFile&) = delete;
+    SegmentedFile& operator=(const SegmentedFile&) = delete;
+    SegmentedFile(SegmentedFile&&) = delete;
+    SegmentedFile& operator=(SegmentedFile&&) = delete;
+
+    std::ostream& stream() { return m_stream; }
+
+    // The current segment has no content yet, the caller writes its header
+    bool needs_header() const { return m_needs_header; }
+    void header_written() { m_needs_header = false; }
+
+    // Call after each record. Returns true when a new segment was started.
+    // The size is only checked every ROTATION_CHECK_RECORDS records, so segments may
+    // overshoot max_bytes by that many records.
+    bool record_written() {
+        if (++m_unchecked < ROTATION_CHECK_RECORDS) return false;
+        m_unchecked = 0;
+        return rotate_if_due(true);
+    }
+
+    // Call when the writer is idle, covers time based rotation when no data is flowing
+    bool idle() { return m_policy.interval_s > 0 && rotate_if_due(false); }
+
+    // Writes out what is buffered, closes the current segment and fsyncs it and its directory.
+    // Returns false if some of it may not have reached the disk. Nothing is written after this.
+    bool close();
+
+    const std::string& current_path() const { return m_current; }
+    uint32_t segments_opened() const { return m_segments; }
+
+    // io_uring writer in use (nullptr: stream writer)
+    const UringFileBuf* uring() const { return m_uring.get(); }
+
+private:
+    bool rotate_if_due(bool check_size);
+    bool open(const std::string& path);
+    uint64_t size();
+    std::time_t period_of(std::time_t now) const;
+
+    std::string m_base;
+    OutputPolicy m_policy;
+    SegmentCompressor* m_compressor;
+    std::filebuf m_filebuf;
+    std::unique_ptr<UringFileBuf> m_uring;
+    std::ostream m_stream{nullptr};
+    std::string m_current;
+    std::time_t m_period = 0;
+    uint32_t m_index = 0;
+    uint32_t m_unchecked = 0;
+    uint32_t m_segments = 0;
+    bool m_needs_header = false;
+    bool m_closed = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace sparkland {
+
+// Single writer, any number of readers. The writer never waits; readers retry
+// if they raced with a write. The payload is stored as relaxed atomic words so
+// torn reads are detected by the sequence check rather than being a data race.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    SeqLock() {
+        for (auto& word : m_words) word.store(0, std::memory_order_relaxed);
+    }
+
+    // Delete copy/move operations
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+    SeqLock(SeqLock&&) = delete;
+    SeqLock& operator=(SeqLock&&) = delete;
+
+    // Writer side (single thread only)
+    void store(const T& value) {
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);  // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Single attempt, returns false if a write was in progress or raced
+    bool try_load(T& out) const {
+        uint64_t version;
+        return try_load(out, version);
+    }
+
+    // Same, also returning the number of writes the copy includes
+    bool try_load(T& out, uint64_t& version) const {
+        uint64_t seq_before = m_seq.load(std::memory_order_acquire);
+        if (seq_before & 1) return false;
+
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) != seq_before) return false;
+
+        std::memcpy(&out, words, sizeof(T));
+        version = seq_before / 2;
+        return true;
+    }
+
+    // Retry until a consistent copy is read
+    T load() const {
+        T out;
+        while (!try_load(out)) {
+        }
+        return out;
+    }
+
+    T load(uint64_t& version) const {
+        T out;
+        while (!try_load(out, version)) {
+        }
+        return out;
+    }
+
+    // Number of completed writes
+    uint64_t version() const {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    alignas(64) std::atomic<uint64_t> m_seq{0};
+    std::atomic<uint64_t> m_words[WORDS];
+};
+
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef SHM_BUS_H
+#define SHM_BUS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "sparkland/seqlock.h"
+#include "sparkland/tick.h"
+
+namespace sparkland {
+
+// Bumped on every change of the shared memory layout or of the Tick records
+constexpr uint32_t SHM_BUS_SCHEMA_VERSION = 3;
+constexpr uint64_t SHM_BUS_MAGIC = 0x3153554242534c53;  // "SLSBBUS1"
+constexpr size_t SHM_BUS_MAX_PRODUCTS = 64;
+
+// POSIX shared memory object (shm_open + mmap). The owner creates it read-write, replacing any
+// object left with the same name, and unlinks it on destruction; processes that attach map it
+// read-only and keep their mapping after the owner is gone.
+class SharedMemoryRegion {
+public:
+    // Owner side, throws std::runtime_error on failure
+    static SharedMemoryRegion create(const std::string& name, size_t bytes);
+    // Read-only attach, throws std::runtime_error if the object doesn't exist
+    static SharedMemoryRegion attach(const std::string& name);
+
+    SharedMemoryRegion(SharedMemoryRegion&& other) noexcept;
+    SharedMemoryRegion& operator=(SharedMemoryRegion&&) = delete;
+    ~SharedMemoryRegion();
+
+    // Delete copy operations
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    void* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const std::string& name() const { return m_name; }
+
+private:
+    SharedMemoryRegion(std::string name, void* data, size_t size, bool owner)
+        : m_name(std::move(name)), m_data(data), m_size(size), m_owner(owner) {}
+
+    std::string m_name;
+    void* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_owner = false;
+};
+
+// Wall clock in nanoseconds, the heartbeat's time base (comparable across processes)
+uint64_t shm_bus_clock_ns();
+
+// Start of the shared memory object. Written once by the producer before the magic is set,
+// except for the atomics.
+struct ShmBusHeader {
+    uint64_t magic;
+    uint32_t schema_version;
+    uint32_t tick_fields;    // tick_fields mask of the records
+    uint32_t record_size;    // sizeof the record, guards against layout mismatches
+    uint32_t capacity;       // ring slots, power of two
+    uint32_t product_count;
+    uint32_t producer_pid;
+    uint64_t started_ns;     // a new value means the producer restarted
+    uint64_t ring_offset;    // from the start of the object
+    uint64_t table_offset;
+    char products[SHM_BUS_MAX_PRODUCTS][16];
+
+    alignas(64) std::atomic<uint64_t> published;     // sequences [0, published) are readable
+    alignas(64) std::atomic<uint64_t> heartbeat_ns;  // refreshed by the producer while it is alive
+    std::atomic<uint32_t> closed;                    // the producer shut down, no more ticks
+};
+
+// Ring slot carrying its sequence, so readers that can't gate the producer detect overwrites
+template <typename T>
+struct alignas(64) ShmBusSlot {
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    static constexpr uint64_t WRITING = uint64_t{1} << 63;
+
+    std::atomic<uint64_t> sequence;  // sequence stored in the slot, WRITING set while it changes
+    std::atomic<uint64_t> words[WORDS];
+};
+
+// Shared memory tick bus for other processes on the host: a broadcast ring of every tick plus a
+// latest-value table per product. Producer side, written from the parser thread; it never waits
+// for readers, which keep their own cursors in their own process (ShmTickBusReader) and detect
+// being lapped. The layout is fixed by the schema version in the header.
+template <typename T>
+class ShmTickBus {
+    static_assert(std::is_trivially_copyable<T>::value, "ShmTickBus records must be trivially copyable");
+
+public:
+    // Creates (replacing) the shared memory object name, e.g. "/sparkland-ticks"
+    ShmTickBus(const std::string& name, const std::vector<std::string>& product_ids, size_t capacity);
+    ~ShmTickBus();
+
+    // Delete copy/move operations
+    ShmTickBus(const ShmTickBus&) = delete;
+    ShmTickBus& operator=(const ShmTickBus&) = delete;
+    ShmTickBus(ShmTickBus&&) = delete;
+    ShmTickBus& operator=(ShmTickBus&&) = delete;
+
+    // Returns -1 for unknown products
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_product_ids.size(); ++i) {
+            if (m_product_ids[i] == product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Append the tick to the ring and make it the product's latest value (index from index_of,
+    // -1 skips the table)
+    void publish(int index, const T& tick) {
+        uint64_t sequence = m_header->published.load(std::memory_order_relaxed);
+        ShmBusSlot<T>& slot = m_ring[sequence & m_mask];
+
+        uint64_t words[ShmBusSlot<T>::WORDS] = {};
+        std::memcpy(words, &tick, sizeof(T));
+        slot.sequence.store(sequence | ShmBusSlot<T>::WRITING, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < ShmBusSlot<T>::WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence, std::memory_order_release);
+        m_header->published.store(sequence + 1, std::memory_order_release);
+
+        if (index >= 0) m_table[index].store(tick);
+    }
+
+    // Refresh the heartbeat, readers treat a stale one as a dead producer
+    void heartbeat() { m_header->heartbeat_ns.store(shm_bus_clock_ns(), std::memory_order_release); }
+
+    uint64_t published() const { return m_header->published.load(std::memory_order_relaxed); }
+    size_t capacity() const { return m_mask + 1; }
+    const std::string& name() const { return m_region.name(); }
+
+private:
+    SharedMemoryRegion m_region;
+    std::vector<std::string> m_product_ids;
+    ShmBusHeader* m_header;
+    ShmBusSlot<T>* m_ring;
+    SeqLock<T>* m_table;
+    uint64_t m_mask;
+};
+
+// Consumer side, in any process: attaches read-only and reads with its own cursor, starting at
+// the newest tick. A reader that falls a full ring behind skips ahead and counts the loss.
+// Exposes the ring consumer interface (acquire_filled_slot / release_slot / empty) on a local copy.
+template <typename T>
+class ShmTickBusReader {
+public:
+    // Throws std::runtime_error if the bus doesn't exist, isn't initialized yet or has a
+    // different schema version or record layout
+    explicit ShmTickBusReader(const std::string& name);
+
+    // Delete copy/move operations
+    ShmTickBusReader(const ShmTickBusReader&) = delete;
+    ShmTickBusReader& operator=(const ShmTickBusReader&) = delete;
+    ShmTickBusReader(ShmTickBusReader&&) = delete;
+    ShmTickBusReader& operator=(ShmTickBusReader&&) = delete;
+
+    // Copy of the next tick, nullptr if there is none yet
+    T* acquire_filled_slot() {
+        while (true) {
+            uint64_t published = m_header->published.load(std::memory_order_acquire);
+            if (m_cursor >= published) return nullptr;
+
+            // Lapped: resume at the oldest tick still in the ring
+            if (published - m_cursor > m_capacity) {
+                m_dropped += published - m_capacity - m_cursor;
+                m_cursor = published - m_capacity;
+            }
+
+            if (read_slot(m_cursor, m_current)) return &m_current;
+
+            // Overwritten while reading
+            ++m_dropped;
+            ++m_cursor;
+        }
+    }
+
+    void release_slot() { ++m_cursor; }
+
+    bool empty() const { return m_cursor >= m_header->published.load(std::memory_order_acquire); }
+
+    // Latest tick of a product, false if it never ticked (or the producer died mid-update)
+    bool read_latest(size_t index, T& out) const {
+        if (index >= m_product_ids.size()) return false;
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+            if (m_table[index].try_load(out)) return m_table[index].version() > 0;
+        }
+        return false;
+    }
+
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_product_ids.size(); ++i) {
+            if (m_product_ids[i] == product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Producer gone: shut down cleanly or no heartbeat for max_age_ns
+    bool producer_stale(uint64_t max_age_ns) const {
+        if (m_header->closed.load(std::memory_order_acquire)) return true;
+        uint64_t heartbeat = m_header->heartbeat_ns.load(std::memory_order_acquire);
+        return shm_bus_clock_ns() - heartbeat > max_age_ns;
+    }
+
+    uint64_t dropped() const { return m_dropped; }
+    uint64_t heartbeat_ns() const { return m_header->heartbeat_ns.load(std::memory_order_acquire); }
+    uint64_t started_ns() const { return m_header->started_ns; }
+    uint32_t producer_pid() const { return m_header->producer_pid; }
+    const std::vector<std::string>& product_ids() const { return m_product_ids; }
+
+private:
+    static constexpr int MAX_READ_ATTEMPTS = 1000;
+
+    bool read_slot(uint64_t sequence, T& out) const {
+        const ShmBusSlot<T>& slot = m_ring[sequence & (m_capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) return false;
+
+        uint64_t words[ShmBusSlot<T>::WORDS];
+        for (size_t i = 0; i < ShmBusSlot<T>::WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) return false;
+
+        std::memcpy(&out, words, sizeof(T));
+        return true;
+    }
+
+    SharedMemoryRegion m_region;
+    const ShmBusHeader* m_header;
+    const ShmBusSlot<T>* m_ring;
+    const SeqLock<T>* m_table;
+    uint64_t m_capacity;
+    std::vector<std::string> m_product_ids;
+    uint64_t m_cursor = 0;
+    uint64_t m_dropped = 0;
+    T m_current{};
+};
+
+extern template class ShmTickBus<Tick>;
+extern template class ShmTickBus<SlimTick>;
+extern template class ShmTickBusReader<Tick>;
+extern template class ShmTickBusReader<SlimTick>;
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SNAPSHOT_CACHE_H
+#define SNAPSHOT_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "sparkland/decimal.h"
+#include "sparkland/seqlock.h"
+
+namespace sparkland {
+
+// Latest top-of-book state of one product
+struct TopOfBook {
+    Decimal64 price;
+    Decimal64 best_bid;
+    Decimal64 best_bid_size;
+    Decimal64 best_ask;
+    Decimal64 best_ask_size;
+    Decimal64 mid_price;
+    double price_ema = 0.0;
+    double mid_price_ema = 0.0;
+    uint64_t sequence = 0;
+
+    // Level-2 book derived values (level2 / level2_batch channel)
+    double microprice = 0.0;
+    double weighted_mid = 0.0;
+    double microprice_ema = 0.0;
+    double weighted_mid_ema = 0.0;
+};
+
+// Per-product latest value table written by TickParser and readable from any
+// thread without locks. Each product owns its own cache-line aligned seqlock,
+// so readers never stall the writer and products never false-share.
+class SnapshotCache {
+public:
+    explicit SnapshotCache(const std::vector<std::string>& product_ids)
+        : m_product_ids(product_ids),
+          m_slots(new SeqLock<TopOfBook>[product_ids.size()]),
+          m_staged(new TopOfBook[product_ids.size()]) {}
+
+    // Delete copy/move operations since readers hold references into the slots
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache& operator=(const SnapshotCache&) = delete;
+    SnapshotCache(SnapshotCache&&) = delete;
+    SnapshotCache& operator=(SnapshotCache&&) = delete;
+
+    // Returns -1 for unknown products
+    // Linear scan: product universes are small and this stays in one cache line or two
+    int index_of(std::string_view product_id) const {
+        for (size_t i = 0; i < m_product_ids.size(); ++i) {
+            if (m_product_ids[i] == product_id) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Writer side (parser thread only)
+    // stage() returns the writer's private copy so independent feeds (ticker, level2)
+    // can each refresh their own fields, publish() makes it visible to readers
+    TopOfBook& stage(size_t index) { return m_staged[index]; }
+
+    void publish(size_t index) {
+        m_slots[index].store(m_staged[index]);
+    }
+
+    void update(size_t index, const TopOfBook& top) {
+        m_staged[index] = top;
+        publish(index);
+    }
+
+    bool update(std::string_view product_id, const TopOfBook& top) {
+        int index = index_of(product_id);
+        if (index < 0) return false;
+        update(static_cast<size_t>(index), top);
+        return true;
+    }
+
+    // Reader side: returns a consistent copy, false if the product was never updated
+    bool read(size_t index, TopOfBook& out) const {
+        if (index >= m_product_ids.size()) return false;
+        const auto& slot = m_slots[index];
+        out = slot.load();
+        return slot.version() > 0;
+    }
+
+    bool read(std::string_view product_id, TopOfBook& out) const {
+        int index = index_of(product_id);
+        return index >= 0 && read(static_cast<size_t>(index), out);
+    }
+
+    // Number of updates applied to a product, readers can poll this for changes
+    uint64_t version(size_t index) const {
+        return m_slots[index].version();
+    }
+
+    size_t size() const { return m_product_ids.size(); }
+    const std::string& product_id(size_t index) const { return m_product_ids[index]; }
+
+private:
+    std::vector<std::string> m_product_ids;
+    std::unique_ptr<SeqLock<TopOfBook>[]> m_slots;
+    std::unique_ptr<TopOfBook[]> m_staged;
+};
+
+}
+
+#endif
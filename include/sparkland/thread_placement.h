@@ -0,0 +1,56 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sparkland {
+
+// Pick the next CPU from the kernel's isolated set (isolcpus=), see resolve_cpu()
+constexpr int AUTO_ISOLATED_CPU = -2;
+
+// Where and how a pipeline thread runs
+struct ThreadPlacement {
+    int cpu = -1;          // -1: let the OS place the thread, AUTO_ISOLATED_CPU: next isolated CPU
+    int rt_priority = 0;   // 1-99: SCHED_FIFO with this priority, 0: normal scheduling
+    std::string name;      // shown by top/perf, truncated to 15 characters
+};
+
+// Apply placement to the calling thread (affinity, scheduling policy, name).
+// Every failing step is logged and makes it return false; the thread keeps running
+// with whatever could be applied.
+bool apply_thread_placement(const ThreadPlacement& placement);
+
+// Run the calling thread as background work: SCHED_IDLE, nice 19 and the idle I/O class,
+// so it only gets CPU time and disk bandwidth the pipeline threads leave unused.
+// Failing steps are logged; returns false if any failed.
+bool apply_background_priority(const std::string& name);
+
+// Pin the calling thread to one CPU, cpu < 0 leaves placement to the OS
+bool pin_current_thread(int cpu);
+
+// Parse a kernel cpu list such as "2-5,8"
+std::vector<int> parse_cpu_list(std::string_view list);
+
+// CPUs isolated from the scheduler (/sys/devices/system/cpu/isolated)
+std::vector<int> isolated_cpus();
+
+// Turns AUTO_ISOLATED_CPU into a concrete isolated CPU, handing out each one once per process.
+// Returns -1 (unpinned) when none are left; other values are returned unchanged.
+int resolve_cpu(int cpu);
+
+// Lock all current and future pages of the process in RAM (mlockall)
+// Needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK
+bool lock_memory();
+
+// Touch every page of [addr, addr + bytes) so the first use on the hot path doesn't page fault
+void prefault_memory(void* addr, size_t bytes);
+
+// Touch the top `bytes` of the calling thread's stack
+void prefault_stack(size_t bytes = 256 * 1024);
+
+}
+
+#endif
@@ -1,38 +1,112 @@
 #ifndef TICK_H
 #define TICK_H
+#include <array>
 #include <string>
+#include <cstdint>
+#include "sparkland/decimal.h"
 
 namespace sparkland {
 
-struct Tick {
-    char type[16];        // e.g., "ticker"
+// Optional ticker field groups. product_id, price, best bid/ask with sizes, mid price
+// and the EMAs are always present.
+namespace tick_fields {
+constexpr uint32_t TYPE = 1u << 0;       // type
+constexpr uint32_t SEQUENCE = 1u << 1;   // sequence
+constexpr uint32_t STATS_24H = 1u << 2;  // open_24h, volume_24h, low_24h, high_24h, volume_30d
+constexpr uint32_t SIDE = 1u << 3;       // side
+constexpr uint32_t TIME = 1u << 4;       // time
+constexpr uint32_t TRADE_ID = 1u << 5;   // trade_id
+constexpr uint32_t LAST_SIZE = 1u << 6;  // last_size
+constexpr uint32_t WINDOW_STATS = 1u << 7;  // window_stats, computed (needs LAST_SIZE)
+constexpr uint32_t RECEIVE_TIME = 1u << 8;  // receive_time_ns, wall clock at the socket read
+
+constexpr uint32_t ALL = TYPE | SEQUENCE | STATS_24H | SIDE | TIME | TRADE_ID | LAST_SIZE | WINDOW_STATS |
+                         RECEIVE_TIME;
+
+// Price, bid/ask, sizes, sequence and EMAs
+constexpr uint32_t SLIM = SEQUENCE;
+}
+
+// Rolling windows of the window statistics, in seconds
+constexpr std::array<uint32_t, 3> STATS_WINDOWS_S = {1, 5, 60};
+
+// Statistics of one product's ticks over the last window (see WindowStats)
+struct WindowStat {
+    double vwap;          // weighted by last_size, 0 if nothing traded
+    double volatility;    // realized: sqrt of the summed squared tick-to-tick log returns
+    double mean_spread;   // best_ask - best_bid
+    uint64_t tick_count;
+};
+
+// Storage of the optional groups, empty bases (no space) when the group is not selected
+namespace tick_parts {
+template <bool> struct Type {};
+template <> struct Type<true> { char type[16]; };          // e.g., "ticker"
+
+template <bool> struct Sequence {};
+template <> struct Sequence<true> { uint64_t sequence; };
+
+template <bool> struct Stats24h {};
+template <> struct Stats24h<true> {
+    Decimal64 open_24h;
+    Decimal64 volume_24h;
+    Decimal64 low_24h;
+    Decimal64 high_24h;
+    Decimal64 volume_30d;
+};
+
+template <bool> struct Side {};
+template <> struct Side<true> { char side[8]; };           // "buy" / "sell"
+
+template <bool> struct Time {};
+template <> struct Time<true> { char time[32]; };          // timestamp
+
+template <bool> struct TradeId {};
+template <> struct TradeId<true> { uint64_t trade_id; };
+
+template <bool> struct LastSize {};
+template <> struct LastSize<true> { Decimal64 last_size; };
+
+template <bool> struct WindowStats {};
+template <> struct WindowStats<true> { WindowStat window_stats[STATS_WINDOWS_S.size()]; };  // per STATS_WINDOWS_S
+
+template <bool> struct ReceiveTime {};
+template <> struct ReceiveTime<true> { int64_t receive_time_ns; };  // CLOCK_REALTIME, ns since the epoch
+}
+
+// Tick with only the fields selected by Fields (tick_fields mask). The parser never looks up
+// the other fields and the CSV logger writes matching columns.
+template <uint32_t Fields>
+struct BasicTick : tick_parts::Type<(Fields & tick_fields::TYPE) != 0>,
+                   tick_parts::Sequence<(Fields & tick_fields::SEQUENCE) != 0>,
+                   tick_parts::Stats24h<(Fields & tick_fields::STATS_24H) != 0>,
+                   tick_parts::Side<(Fields & tick_fields::SIDE) != 0>,
+                   tick_parts::Time<(Fields & tick_fields::TIME) != 0>,
+                   tick_parts::TradeId<(Fields & tick_fields::TRADE_ID) != 0>,
+                   tick_parts::LastSize<(Fields & tick_fields::LAST_SIZE) != 0>,
+                   tick_parts::WindowStats<(Fields & tick_fields::WINDOW_STATS) != 0>,
+                   tick_parts::ReceiveTime<(Fields & tick_fields::RECEIVE_TIME) != 0> {
+    static constexpr uint32_t FIELDS = Fields;
+    static constexpr bool has(uint32_t field) { return (Fields & field) == field; }
+
     char product_id[16];  // e.g., "ETH-USD"
-    char side[8];         // "buy" / "sell"
-    char time[32];        // timestamp
-
-    // Prices & volumes
-    double price;
-    double open_24h;
-    double volume_24h;
-    double low_24h;
-    double high_24h;
-    double volume_30d;
-    double best_bid;
-    double best_bid_size;
-    double best_ask;
-    double best_ask_size;
-    double last_size;
-
-    // Trade identifiers
-    uint64_t sequence;
-    uint64_t trade_id;
+
+    // Prices & volumes (exact, as quoted by the exchange)
+    Decimal64 price;
+    Decimal64 best_bid;
+    Decimal64 best_bid_size;
+    Decimal64 best_ask;
+    Decimal64 best_ask_size;
 
     // Custom fields
-    double mid_price;
+    Decimal64 mid_price;
     double price_ema;
     double mid_price_ema;
 };
 
+using Tick = BasicTick<tick_fields::ALL>;
+using SlimTick = BasicTick<tick_fields::SLIM>;
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -5,73 +5,155 @@
 #include <iostream>
 #include <cstring>
 #include <chrono>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <simdjson.h>
 #include "sparkland/types.h"
 #include "sparkland/ema.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/feed_state.h"
+#include "sparkland/window_stats.h"
+#include "sparkland/snapshot_cache.h"
+#include "sparkland/order_book.h"
+#include "sparkland/bar_aggregator.h"
+#include "sparkland/conflating_buffer.h"
+#include "sparkland/shm_bus.h"
 
 namespace sparkland {
 
-class TickParser {
+// Smallest iterate_many window, batches are usually a handful of small frames
+constexpr size_t MIN_BATCH_WINDOW = 64 * 1024;
+
+// Input the parser rejected or had to cut, counted instead of logged so a malformed or hostile
+// feed can't slow the hot path down with I/O
+struct ParserStats {
+    uint64_t json_errors = 0;       // malformed JSON or a field of the wrong type
+    uint64_t truncated_fields = 0;  // string values longer than their fixed size field
+    uint64_t malformed_numbers = 0; // prices/sizes that don't parse or don't fit, read as 0 on ticks
+    uint64_t unknown_products = 0;  // ticker messages for products that weren't subscribed
+    simdjson::error_code last_error = simdjson::SUCCESS;
+};
+
+// Ring is the producer side the ticks are published to (TickRingBuffer, TickBroadcastRing or
+// SlimTickBroadcastRing), its slot type decides which ticker fields are parsed.
+// Defined in tick_parser.cpp and explicitly instantiated for each
+template <typename Ring>
+class BasicTickParser {
 public:
-    TickParser(TickRingBuffer& ringBuffer, const std::vector<std::string>& product_ids);
+    using TickType = std::remove_pointer_t<decltype(std::declval<Ring&>().acquire_free_slot())>;
+
+    // snapshot_cache is optional, when set it receives the latest top-of-book of every tick
+    // bar_ring is optional, when set trades (matches channel) are aggregated into bars published there
+    BasicTickParser(Ring& ringBuffer, const std::vector<std::string>& product_ids,
+                    SnapshotCache* snapshot_cache = nullptr, BarRingBuffer* bar_ring = nullptr,
+                    double ema_period_s = DEFAULT_EMA_PERIOD_S);
 
     // Delete copy/move operations since ring_buffer reference can cause issue
-    TickParser(const TickParser&) = delete;
-    TickParser& operator=(const TickParser&) = delete;
-    TickParser(TickParser&&) = delete;
-    TickParser& operator=(TickParser&&) = delete;
+    BasicTickParser(const BasicTickParser&) = delete;
+    BasicTickParser& operator=(const BasicTickParser&) = delete;
+    BasicTickParser(BasicTickParser&&) = delete;
+    BasicTickParser& operator=(BasicTickParser&&) = delete;
     
     // Explicit destructor
-    ~TickParser() = default;
+    ~BasicTickParser() = default;
     
     // Parse incoming JSON packet into next available Tick slot
+    // Level-2 messages (snapshot / l2update) are applied to the product's order book instead
     // Returns true if successfully parsed & pushed, false if buffer full or parse error
     bool parse_and_push(simdjson::padded_string_view payload);
 
+    // Parse several newline separated messages (e.g. all frames of one socket read) with a
+    // single stage 1 pass and publish their ticks to the ring together. After a malformed
+    // message the rest are parsed one by one, so one bad frame doesn't take the batch with it
+    // Returns the number of messages that failed
+    size_t parse_batch(simdjson::padded_string_view payloads);
+
+    // Publish every open bar whose interval has elapsed at now_us (e.g. before shutdown)
+    // Must be called from the thread calling parse_and_push
+    void flush_bars(int64_t now_us);
+
+    // Publishes the end of stream marker to the tick ring, bar ring and conflating stage so
+    // their sinks drain up to here and stop. Nothing may be parsed afterwards.
+    // Must be called from the thread calling parse_and_push, or once it stopped
+    void end_of_stream();
+
+    // Bars that could not be published because the bar ring was full
+    uint64_t dropped_bars() const { return m_dropped_bars; }
+
+    // Only safe to read from the thread calling parse_and_push, or once it stopped
+    const ParserStats& stats() const { return m_stats; }
+
+    // Optional conflating stage, receives every tick including those dropped because the ring
+    // was full. Must be set before parsing starts
+    void set_conflation(ConflatingBuffer<TickType>* conflation) { m_conflation = conflation; }
+
+    // Optional shared memory bus for other processes, receives every tick like the conflating
+    // stage (it never blocks on readers). Must be set before parsing starts
+    void set_shm_bus(ShmTickBus<TickType>* bus) { m_shm_bus = bus; }
+
+    // Wall clock of the socket read the next messages came from (see ParserHandler::received),
+    // stamped on their ticks. Until it is set ticks are stamped when parsed
+    void set_receive_time(int64_t receive_ns) { m_receive_ns = receive_ns; }
+
+    // Optional exchange-to-local lag and stale feed tracking, receives every tick.
+    // Must be set before parsing starts
+    void set_latency_monitor(FeedLatencyMonitor* monitor) { m_latency = monitor; }
+
+    // Optional periodic snapshots of the per-product state for warm restarts, staged on every
+    // tick. Must be set before parsing starts
+    void set_snapshotter(FeedStateSnapshotter* snapshotter) { m_snapshotter = snapshotter; }
+
+    // Warm restart: continues the EMAs, top-of-book and sequence of a snapshot read at now_ns
+    // (see read_feed_state) and seeds the snapshot cache and snapshotter with them.
+    // Products not subscribed any more are ignored. Must be called before parsing starts.
+    // Returns the number of products restored
+    size_t restore(const FeedState& state, int64_t now_ns);
+
+    // Level-2 book of a subscribed product, nullptr if unknown
+    // Only safe to read from the thread calling parse_and_push
+    const OrderBook* book(const std::string& product_id) const;
+
 private:
-    TickRingBuffer& m_ring_buffer;
+    struct ProductBook {
+        OrderBook book;
+        EMA ema;  // Tracks microprice and depth-weighted mid
+    };
+
+    size_t parse_frames(simdjson::padded_string_view payloads, size_t offset);
+    bool handle_document(simdjson::ondemand::document_reference doc);
+    bool apply_book_message(simdjson::ondemand::document_reference doc, bool is_snapshot);
+    bool apply_match(simdjson::ondemand::document_reference doc);
+    void publish_bar(const Bar& bar);
+    void count_json_error(simdjson::error_code error);
+
+    Ring& m_ring_buffer;
     simdjson::ondemand::parser m_parser;
     std::unordered_map<std::string, EMA> m_ema_store;
+    std::unordered_map<std::string, WindowStats> m_window_stats;  // only if TickType has WINDOW_STATS
+    std::unordered_map<std::string, ProductBook> m_books;
+    SnapshotCache* m_snapshot_cache;
+    BarRingBuffer* m_bar_ring;
+    std::unordered_map<std::string, std::vector<BarAggregator>> m_bars;
+    uint64_t m_dropped_bars = 0;
+    ParserStats m_stats;
+    ConflatingBuffer<TickType>* m_conflation = nullptr;
+    ShmTickBus<TickType>* m_shm_bus = nullptr;
+    FeedLatencyMonitor* m_latency = nullptr;
+    FeedStateSnapshotter* m_snapshotter = nullptr;
+    int64_t m_receive_ns = 0;
+    TickType m_overflow{};  // parse target when the ring is full, for conflation and the bus
+    bool m_batching = false;
+    size_t m_batch_pending = 0;  // ticks of the current batch filled but not published yet
+};
 
-    inline std::chrono::system_clock::time_point parse_iso8601(std::string_view str, size_t len) {
-        // Expected format: YYYY-MM-DDTHH:MM:SS.ssssssZ
-        // Example: 2022-10-19T23:28:22.061769Z
+extern template class BasicTickParser<TickRingBuffer>;
+extern template class BasicTickParser<TickBroadcastRing>;
+extern template class BasicTickParser<SlimTickBroadcastRing>;
 
-        int year = (str[0]-'0')*1000 + (str[1]-'0')*100 + (str[2]-'0')*10 + (str[3]-'0');
-        int month = (str[5]-'0')*10 + (str[6]-'0');
-        int day = (str[8]-'0')*10 + (str[9]-'0');
-        int hour = (str[11]-'0')*10 + (str[12]-'0');
-        int minute = (str[14]-'0')*10 + (str[15]-'0');
-        int second = (str[17]-'0')*10 + (str[18]-'0');
-    
-        // Convert to time_t (UTC)
-        std::tm t{};
-        t.tm_year = year - 1900;
-        t.tm_mon = month - 1;
-        t.tm_mday = day;
-        t.tm_hour = hour;
-        t.tm_min = minute;
-        t.tm_sec = second;
-    
-        std::time_t time_sec = timegm(&t);
-    
-        auto tp = std::chrono::system_clock::from_time_t(time_sec);
-    
-        // Fractional seconds
-        if (len > 20 && str[19] == '.') {
-            int micros = 0;
-            int factor = 100000;
-            for (size_t i = 20; i < len && std::isdigit(str[i]) && factor > 0; ++i) {
-                micros += (str[i]-'0') * factor;
-                factor /= 10;
-            }
-            tp += std::chrono::microseconds(micros);
-        }
-    
-        return tp;
-    }
-};
+using TickParser = BasicTickParser<TickRingBuffer>;
+using BroadcastTickParser = BasicTickParser<TickBroadcastRing>;
+using SlimBroadcastTickParser = BasicTickParser<SlimTickBroadcastRing>;
 
 }
 
@@ -0,0 +1,71 @@
+#ifndef TICKER_GENERATOR_H
+#define TICKER_GENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sparkland {
+
+// Synthetic product ids have three digits, SIM000-USD to SIM999-USD
+constexpr uint32_t MAX_SYNTHETIC_PRODUCTS = 1000;
+
+// What the feed simulator sends, see TickerGenerator and FeedSimulator
+struct FeedProfile {
+    double rate = 10000.0;       // ticker messages per second, sustained
+    uint32_t burst = 1;          // messages sent back to back, bursts are spaced to keep the rate
+    uint32_t product_count = 3;  // synthetic products SIM000-USD, SIM001-USD, ... at most MAX_SYNTHETIC_PRODUCTS
+    double duration_s = 10.0;    // 0 streams until stopped
+    uint64_t seed = 1;           // same seed, same synthetic messages
+    std::string replay_path;     // recorded feed (one JSON message per line), its ticker messages are sent instead
+};
+
+// Builds the ticker messages of a FeedProfile. Synthetic messages are a seeded random walk
+// per product, cycled round robin; recorded messages are replayed in order and looped. The
+// "time" of every message is the send time so receivers can measure latency.
+class TickerGenerator {
+public:
+    // Throws std::runtime_error if the replay file can't be read or has no ticker messages,
+    // std::invalid_argument if product_count is above MAX_SYNTHETIC_PRODUCTS
+    explicit TickerGenerator(const FeedProfile& profile);
+
+    // Next message stamped with send time now_ns (epoch), valid until the next call
+    const std::string& next(int64_t now_ns);
+
+    // Products the messages are for, what a client has to subscribe to
+    const std::vector<std::string>& products() const { return m_products; }
+
+    uint64_t generated() const { return m_generated; }
+
+private:
+    struct SyntheticProduct {
+        std::string id;
+        int64_t price_cents;
+        int64_t open_cents;
+        int64_t low_cents;
+        int64_t high_cents;
+    };
+
+    // Recorded message split around the value of its "time" field
+    struct RecordedMessage {
+        std::string prefix;
+        std::string suffix;
+        bool has_time;
+    };
+
+    void load_replay(const std::string& path);
+    void build_synthetic(int64_t now_ns);
+
+    std::vector<std::string> m_products;
+    std::vector<SyntheticProduct> m_synthetic;
+    std::vector<RecordedMessage> m_recorded;
+    std::mt19937_64 m_random;
+    std::string m_message;
+    uint64_t m_generated = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef TRADE_H
+#define TRADE_H
+
+#include <cstdint>
+#include "sparkland/decimal.h"
+
+namespace sparkland {
+
+// One execution from the matches channel
+struct Trade {
+    char product_id[16];  // e.g., "ETH-USD"
+    char side[8];         // maker side, "buy" / "sell"
+    uint64_t trade_id;
+    uint64_t sequence;
+    Decimal64 price;
+    Decimal64 size;
+    int64_t time_us;      // exchange time, microseconds since epoch
+};
+
+}
+
+#endif
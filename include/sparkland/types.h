@@ -2,12 +2,19 @@
 #define TYPES_H
 
 #include "ring_buffer.h"
+#include "broadcast_ring.h"
 #include "tick.h"
+#include "bar_aggregator.h"
 
 namespace sparkland {
 
 constexpr size_t TICK_BUFFER_CAPACITY = 1024;
 using TickRingBuffer = RingBuffer<Tick, TICK_BUFFER_CAPACITY>;
+using TickBroadcastRing = BroadcastRing<Tick, TICK_BUFFER_CAPACITY>;
+using SlimTickBroadcastRing = BroadcastRing<SlimTick, TICK_BUFFER_CAPACITY>;
+
+constexpr size_t BAR_BUFFER_CAPACITY = 256;
+using BarRingBuffer = RingBuffer<Bar, BAR_BUFFER_CAPACITY>;
 
 }
 
@@ -0,0 +1,126 @@
+#ifndef URING_FILE_H
+#define URING_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "sparkland/huge_pages.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace sparkland {
+
+constexpr size_t URING_BUFFER_COUNT = 4;
+constexpr size_t URING_BUFFER_SIZE = 1024 * 1024;
+
+// O_DIRECT offsets, lengths and buffer addresses are kept multiples of this
+constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// streambuf that writes a file through io_uring, so the writing thread formats into memory
+// and never blocks in write(2). Rows go into one of buffer_count registered buffers; a full
+// buffer is submitted as an asynchronous write at its file offset and the next free buffer
+// takes over. Buffers come back when their write completes. The thread only waits when every
+// buffer is still in flight, i.e. the disk is behind by buffer_count * buffer_size bytes.
+//
+// Optional O_DIRECT bypasses the page cache (no writeback stalls or cache pollution): full
+// buffers are block aligned, the last partial block is padded on close and the file truncated
+// back to its real size. Falls back to buffered I/O where the filesystem rejects O_DIRECT.
+//
+// Uses the raw io_uring syscalls, no liburing. Owned by one thread.
+class UringFileBuf : public std::streambuf {
+public:
+    // Throws std::runtime_error if io_uring is unavailable (seccomp, limits) or can't write
+    // (kernel before 5.6, no IORING_OP_WRITE / IOSQE_ASYNC)
+    explicit UringFileBuf(size_t buffer_count = URING_BUFFER_COUNT, size_t buffer_size = URING_BUFFER_SIZE);
+    ~UringFileBuf() override;
+
+    // Delete copy/move operations
+    UringFileBuf(const UringFileBuf&) = delete;
+    UringFileBuf& operator=(const UringFileBuf&) = delete;
+    UringFileBuf(UringFileBuf&&) = delete;
+    UringFileBuf& operator=(UringFileBuf&&) = delete;
+
+    // Whether io_uring can be set up in this process and supports the writes used here
+    static bool available();
+
+    // Opens path for appending, then finishes the file currently open.
+    // Returns false, keeping the current file, if path can't be opened.
+    bool open(const std::string& path, bool direct_io);
+
+    // Writes out what is buffered, waits for all writes and closes the file
+    void close();
+
+    bool is_open() const { return m_fd >= 0; }
+    bool direct() const { return m_direct; }                    // O_DIRECT in effect
+    bool registered_buffers() const { return m_registered; }    // IORING_OP_WRITE_FIXED in use
+
+    // File size once everything buffered is written
+    uint64_t size() const;
+
+    uint64_t write_errors() const { return m_write_errors; }
+    uint64_t buffer_waits() const { return m_buffer_waits; }  // times every buffer was in flight
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+    // Buffered I/O: submits the partial buffer. O_DIRECT: no-op, only full blocks can be
+    // written before close()
+    int sync() override;
+
+private:
+    struct Buffer {
+        char* data;
+        uint64_t offset = 0;   // file offset of data[0]
+        size_t length = 0;     // bytes to write
+        size_t written = 0;
+        bool in_flight = false;
+    };
+
+    bool setup(size_t entries);
+    void release();
+    void submit_current(bool pad);
+    void submit(size_t index);
+    void start_buffer(size_t index, uint64_t offset, size_t prefix);
+    size_t free_buffer();
+    void reap(bool wait);
+    void finish_file();
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+
+    size_t m_buffer_size;
+    HugePageRegion m_memory;
+    std::vector<Buffer> m_buffers;
+    size_t m_current = 0;
+    size_t m_in_flight = 0;
+    bool m_registered = false;
+
+    int m_fd = -1;
+    bool m_direct = false;
+
+    // Ring mappings
+    int m_ring_fd = -1;
+    unsigned m_features = 0;  // IORING_FEAT_* of the ring
+    void* m_sq_ring = nullptr;
+    size_t m_sq_ring_size = 0;
+    void* m_cq_ring = nullptr;
+    size_t m_cq_ring_size = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_mask = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned* m_cq_mask = nullptr;
+    io_uring_cqe* m_cqes = nullptr;
+
+    uint64_t m_write_errors = 0;
+    uint64_t m_buffer_waits = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace sparkland {
+
+// How a consumer thread idles when its ring is empty
+enum class WaitStrategy {
+    Sleep,     // 10us sleep, lowest CPU usage
+    Yield,     // give up the time slice, reacts within a scheduler quantum
+    BusySpin   // never leaves the core, lowest latency (use with a pinned, isolated core)
+};
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+inline void idle(WaitStrategy strategy) {
+    switch (strategy) {
+        case WaitStrategy::Sleep:
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            break;
+        case WaitStrategy::Yield:
+            std::this_thread::yield();
+            break;
+        case WaitStrategy::BusySpin:
+            cpu_relax();
+            break;
+    }
+}
+
+// "sleep" / "yield" / "spin", returns false for unknown names
+inline bool parse_wait_strategy(std::string_view name, WaitStrategy& out) {
+    if (name == "sleep") out = WaitStrategy::Sleep;
+    else if (name == "yield") out = WaitStrategy::Yield;
+    else if (name == "spin") out = WaitStrategy::BusySpin;
+    else return false;
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef WINDOW_STATS_H
+#define WINDOW_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include "sparkland/tick.h"
+
+namespace sparkland {
+
+// Sums of the ticks of one time bucket (or of a whole window)
+struct WindowSums {
+    double notional = 0.0;         // price * last_size
+    double volume = 0.0;
+    double spread = 0.0;
+    double squared_returns = 0.0;
+    uint64_t count = 0;
+};
+
+// Sliding window over one product's ticks made of BUCKETS time buckets. Running sums are
+// updated per tick and buckets leaving the window are subtracted, so each tick costs O(1)
+// amortized whatever the tick rate. The window slides one bucket (1/BUCKETS of its length)
+// at a time.
+class RollingWindow {
+public:
+    static constexpr int64_t BUCKETS = 20;
+
+    explicit RollingWindow(uint32_t window_s)
+        : m_bucket_ns(static_cast<int64_t>(window_s) * 1000000000 / BUCKETS) {}
+
+    void add(int64_t now_ns, double price, double size, double spread, double squared_return) {
+        advance(now_ns);
+        WindowSums& bucket = m_buckets[m_head % BUCKETS];
+        bucket.notional += price * size;
+        bucket.volume += size;
+        bucket.spread += spread;
+        bucket.squared_returns += squared_return;
+        ++bucket.count;
+        m_totals.notional += price * size;
+        m_totals.volume += size;
+        m_totals.spread += spread;
+        m_totals.squared_returns += squared_return;
+        ++m_totals.count;
+    }
+
+    // Drop the buckets that fell out of the window at now_ns
+    void advance(int64_t now_ns) {
+        int64_t head = now_ns / m_bucket_ns;
+        if (head <= m_head) return;  // same bucket, or a clock step back
+
+        int64_t expired = head - m_head < BUCKETS ? head - m_head : BUCKETS;
+        for (int64_t i = 1; i <= expired; ++i) {
+            WindowSums& bucket = m_buckets[(m_head + i) % BUCKETS];
+            m_totals.notional -= bucket.notional;
+            m_totals.volume -= bucket.volume;
+            m_totals.spread -= bucket.spread;
+            m_totals.squared_returns -= bucket.squared_returns;
+            m_totals.count -= bucket.count;
+            bucket = WindowSums();
+        }
+        m_head = head;
+
+        // Rounding of the subtractions doesn't outlive an empty window
+        if (m_totals.count == 0) m_totals = WindowSums();
+    }
+
+    WindowStat value() const {
+        WindowStat stat{};
+        stat.tick_count = m_totals.count;
+        if (m_totals.count == 0) return stat;
+        stat.vwap = m_totals.volume > 0.0 ? m_totals.notional / m_totals.volume : 0.0;
+        stat.volatility = m_totals.squared_returns > 0.0 ? std::sqrt(m_totals.squared_returns) : 0.0;
+        stat.mean_spread = m_totals.spread / static_cast<double>(m_totals.count);
+        return stat;
+    }
+
+private:
+    int64_t m_bucket_ns;
+    int64_t m_head = 0;  // bucket of the most recent tick
+    std::array<WindowSums, BUCKETS> m_buckets{};
+    WindowSums m_totals;
+};
+
+// Rolling VWAP, realized volatility, mean spread and tick count of one product over each of
+// STATS_WINDOWS_S, updated incrementally from the parser thread
+class WindowStats {
+public:
+    WindowStats() : m_windows(make_windows(std::make_index_sequence<STATS_WINDOWS_S.size()>())) {}
+
+    void update(double price, double size, double best_bid, double best_ask,
+                std::chrono::steady_clock::time_point tick_time,
+                WindowStat (&out)[STATS_WINDOWS_S.size()]) {
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            tick_time.time_since_epoch()).count();
+
+        double squared_return = 0.0;
+        if (m_last_price > 0.0 && price > 0.0) {
+            double log_return = std::log(price / m_last_price);
+            squared_return = log_return * log_return;
+        }
+        if (price > 0.0) m_last_price = price;
+
+        for (size_t i = 0; i < m_windows.size(); ++i) {
+            m_windows[i].add(now_ns, price, size, best_ask - best_bid, squared_return);
+            out[i] = m_windows[i].value();
+        }
+    }
+
+private:
+    template <size_t... I>
+    static std::array<RollingWindow, STATS_WINDOWS_S.size()> make_windows(std::index_sequence<I...>) {
+        return {RollingWindow(STATS_WINDOWS_S[I])...};
+    }
+
+    std::array<RollingWindow, STATS_WINDOWS_S.size()> m_windows;
+    double m_last_price = 0.0;
+};
+
+}
+
+#endif
@@ -3,31 +3,40 @@
 #include <websocketpp/common/asio.hpp>
 #include <websocketpp/common/asio_ssl.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <chrono>
 
 namespace sparkland {
 
-CoinbaseClient::CoinbaseClient(const std::string& uri, const std::vector<std::string>& product_ids)
-    : m_uri(uri), m_product_ids(product_ids), m_logger(Logger::getInstance()) {
+template <typename Handler, typename Config>
+BasicCoinbaseClient<Handler, Config>::BasicCoinbaseClient(const std::string& uri, const std::vector<std::string>& product_ids,
+                                                  const std::vector<std::string>& channels, Handler handler)
+    : m_uri(uri), m_product_ids(product_ids), m_channels(channels), m_handler(std::move(handler)),
+      m_logger(Logger::getInstance()) {
+    m_batch.reserve(MESSAGE_BATCH_RESERVE);
     m_client.clear_access_channels(websocketpp::log::alevel::all);
     m_client.init_asio();
 
-    m_client.set_tls_init_handler([this](websocketpp::connection_hdl hdl) {
-        return this->on_tls_init(hdl);
-    });
+    if constexpr (Config::secure) {
+        m_client.set_tls_init_handler([this](websocketpp::connection_hdl hdl) {
+            return this->on_tls_init(hdl);
+        });
+    }
     m_client.set_open_handler([this](websocketpp::connection_hdl hdl) { on_open(hdl); });
-    m_client.set_message_handler([this](websocketpp::connection_hdl hdl, AsioClient::message_ptr msg) { on_message(hdl, msg); });
+    m_client.set_message_handler([this](websocketpp::connection_hdl hdl, typename Client::message_ptr msg) { on_message(hdl, msg); });
     m_client.set_fail_handler([this](websocketpp::connection_hdl hdl) { on_fail(hdl); });
     m_client.set_close_handler([this](websocketpp::connection_hdl hdl) { on_close(hdl); });
 }
 
-CoinbaseClient::~CoinbaseClient() {
+template <typename Handler, typename Config>
+BasicCoinbaseClient<Handler, Config>::~BasicCoinbaseClient() {
     stop();
 }
 
-void CoinbaseClient::start() {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::start() {
     if (m_running.exchange(true)) return;
 
     m_logger.info("Starting coinbase client");
@@ -42,11 +51,14 @@ void CoinbaseClient::start() {
     m_client.connect(con);
 
     m_thread = std::thread([this]() {
+        apply_thread_placement(m_placement);
+        prefault_stack();
         m_client.run();
     });
 }
 
-void CoinbaseClient::stop() {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::stop() {
     if (!m_running.exchange(false)) return;
 
     m_logger.info("Stopping coinbase client");
@@ -57,40 +69,99 @@ void CoinbaseClient::stop() {
     if (m_thread.joinable()) {
         m_thread.join();
     }
+
+    // Frames batched after the last flush ran
+    flush_batch();
 }
 
-void CoinbaseClient::set_message_handler(MessageHandler handler) {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::set_message_handler(Handler handler) {
     m_handler = std::move(handler);
 }
 
-void CoinbaseClient::on_open(websocketpp::connection_hdl hdl) {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::on_open(websocketpp::connection_hdl hdl) {
     m_connected.store(true, std::memory_order_release);
     m_logger.info("Connected to Coinbase WS");
     send_subscribe();
 }
 
-void CoinbaseClient::on_message(websocketpp::connection_hdl, AsioClient::message_ptr msg) {
-    if (m_handler) {
-        simdjson::padded_string payload(msg->get_payload().data(), msg->get_payload().size());
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::on_message(websocketpp::connection_hdl, typename Client::message_ptr msg) {
+    if (!has_handler()) return;
+    std::string& raw = msg->get_raw_payload();
+
+    if constexpr (supports_receive_time<Handler>::value) {
+        // Frames batched behind the first one came from the same read and share its time
+        if (!m_flush_pending) m_handler.received(wall_clock_ns());
+    }
+
+    if constexpr (supports_batch<Handler>::value) {
+        if (m_flush_pending) {
+            // More frames from the same socket read, parsed together once the read is drained
+            m_batch.append(raw);
+            m_batch.push_back('\n');
+            return;
+        }
+        // The first frame goes out right away (no added latency when the feed is quiet),
+        // the flush runs after this read handler and picks up whatever followed it
+        m_flush_pending = true;
+        m_client.get_io_service().post([this]() { flush_batch(); });
+    }
+
+    // Recycled messages reserve simdjson's padding, parse the payload in place
+    simdjson::padded_string_view payload;
+    if (padded_view(raw, payload)) {
         m_handler(payload);
+        return;
+    }
+
+    // Fragmented frames can outgrow the reservation, copy into the per-message arena
+    m_scratch.reset();
+    auto* copy = static_cast<char*>(m_scratch.allocate(raw.size() + simdjson::SIMDJSON_PADDING));
+    if (copy) {
+        std::memcpy(copy, raw.data(), raw.size());
+        std::memset(copy + raw.size(), 0, simdjson::SIMDJSON_PADDING);
+        m_handler(simdjson::padded_string_view(copy, raw.size(), raw.size() + simdjson::SIMDJSON_PADDING));
+    } else {
+        simdjson::padded_string heap_copy(raw.data(), raw.size());
+        m_handler(heap_copy);
+    }
+}
+
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::flush_batch() {
+    if constexpr (supports_batch<Handler>::value) {
+        m_flush_pending = false;
+        if (m_batch.empty()) return;
+
+        if (m_batch.capacity() - m_batch.size() < simdjson::SIMDJSON_PADDING) {
+            m_batch.reserve(m_batch.size() + simdjson::SIMDJSON_PADDING);
+        }
+        m_handler.batch(simdjson::padded_string_view(m_batch.data(), m_batch.size(), m_batch.capacity()));
+        m_batch.clear();
     }
 }
 
-void CoinbaseClient::on_fail(websocketpp::connection_hdl) {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::on_fail(websocketpp::connection_hdl) {
     m_logger.error("Connection failed");
     m_connected.store(false, std::memory_order_relaxed);
 }
 
-void CoinbaseClient::on_close(websocketpp::connection_hdl) {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::on_close(websocketpp::connection_hdl) {
     m_logger.info("Connection closed");
     m_connected.store(false, std::memory_order_relaxed);
 }
 
-bool CoinbaseClient::is_connected() const {
+template <typename Handler, typename Config>
+bool BasicCoinbaseClient<Handler, Config>::is_connected() const {
     return m_connected.load(std::memory_order_acquire);
 }
 
-void CoinbaseClient::send_subscribe() {
+template <typename Handler, typename Config>
+void BasicCoinbaseClient<Handler, Config>::send_subscribe() {
     std::ostringstream oss;
     oss << R"({"type": "subscribe", "product_ids": [)";
     for (size_t i = 0; i < m_product_ids.size(); ++i) {
@@ -99,7 +170,14 @@ void CoinbaseClient::send_subscribe() {
             oss << ", ";
         }
     }
-    oss << R"(], "channels": ["ticker"]})";
+    oss << R"(], "channels": [)";
+    for (size_t i = 0; i < m_channels.size(); ++i) {
+        oss << "\"" << m_channels[i] << "\"";
+        if (i < m_channels.size() - 1) {
+            oss << ", ";
+        }
+    }
+    oss << "]}";
 
     websocketpp::lib::error_code ec;
     m_client.send(m_hdl, oss.str(), websocketpp::frame::opcode::text, ec);
@@ -108,7 +186,8 @@ void CoinbaseClient::send_subscribe() {
     }
 }
 
-ContextPtr CoinbaseClient::on_tls_init(websocketpp::connection_hdl) {
+template <typename Handler, typename Config>
+ContextPtr BasicCoinbaseClient<Handler, Config>::on_tls_init(websocketpp::connection_hdl) {
     ContextPtr ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::sslv23);
     try {
         ctx->set_options(boost::asio::ssl::context::default_workarounds |
@@ -121,4 +200,10 @@ ContextPtr CoinbaseClient::on_tls_init(websocketpp::connection_hdl) {
     return ctx;
 }
 
+template class BasicCoinbaseClient<MessageHandler>;
+template class BasicCoinbaseClient<BroadcastParserHandler>;
+template class BasicCoinbaseClient<SlimBroadcastParserHandler>;
+template class BasicCoinbaseClient<BroadcastParserHandler, PooledClientConfig>;
+template class BasicCoinbaseClient<SlimBroadcastParserHandler, PooledClientConfig>;
+
 }
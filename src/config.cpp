@@ -0,0 +1,482 @@
+#include "sparkland/config.h"
+
+#include <simdjson.h>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+namespace sparkland {
+
+namespace {
+
+const std::vector<std::string> KNOWN_CHANNELS = {"ticker", "level2", "level2_batch", "matches"};
+
+[[noreturn]] void fail(const std::string& message) {
+    throw std::invalid_argument("Invalid configuration: " + message);
+}
+
+std::vector<std::string> split_list(std::string_view list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string_view::npos) end = list.size();
+        if (end > start) items.emplace_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+std::vector<std::string> read_string_list(simdjson::dom::element value, const std::string& key) {
+    std::vector<std::string> items;
+    simdjson::dom::array array;
+    if (value.get_array().get(array)) fail("'" + key + "' must be an array of strings");
+    for (simdjson::dom::element item : array) {
+        std::string_view str;
+        if (item.get_string().get(str)) fail("'" + key + "' must be an array of strings");
+        items.emplace_back(str);
+    }
+    return items;
+}
+
+std::string read_string(simdjson::dom::element value, const std::string& key) {
+    std::string_view str;
+    if (value.get_string().get(str)) fail("'" + key + "' must be a string");
+    return std::string(str);
+}
+
+int64_t read_int(simdjson::dom::element value, const std::string& key) {
+    int64_t number;
+    if (value.get_int64().get(number)) fail("'" + key + "' must be an integer");
+    return number;
+}
+
+// "auto" takes the next isolated CPU
+int parse_cpu(const std::string& str, const std::string& option);
+
+ThreadPlacement read_thread(simdjson::dom::element value, const std::string& key) {
+    ThreadPlacement thread;
+    simdjson::dom::object object;
+    if (value.get_object().get(object)) fail("'" + key + "' must be an object");
+    for (auto field : object) {
+        if (field.key == "cpu") {
+            std::string_view str;
+            if (field.value.get_string().get(str) == simdjson::SUCCESS) thread.cpu = parse_cpu(std::string(str), key + ".cpu");
+            else thread.cpu = static_cast<int>(read_int(field.value, key + ".cpu"));
+        } else if (field.key == "rt_priority") {
+            thread.rt_priority = static_cast<int>(read_int(field.value, key + ".rt_priority"));
+        } else {
+            fail("unknown key '" + key + "." + std::string(field.key) + "'");
+        }
+    }
+    return thread;
+}
+
+LagPolicy parse_lag_policy(std::string_view name) {
+    if (name == "block") return LagPolicy::Block;
+    if (name == "drop") return LagPolicy::Drop;
+    fail("lag_policy must be 'block' or 'drop', got '" + std::string(name) + "'");
+}
+
+TickProfile parse_tick_profile(std::string_view name) {
+    if (name == "full") return TickProfile::Full;
+    if (name == "slim") return TickProfile::Slim;
+    fail("tick_profile must be 'full' or 'slim', got '" + std::string(name) + "'");
+}
+
+OpenMode parse_open_mode(std::string_view name) {
+    if (name == "append") return OpenMode::Append;
+    if (name == "new_segment") return OpenMode::NewSegment;
+    fail("open_mode must be 'append' or 'new_segment', got '" + std::string(name) + "'");
+}
+
+FileWriter parse_writer(std::string_view name) {
+    if (name == "stream") return FileWriter::Stream;
+    if (name == "io_uring") return FileWriter::IoUring;
+    fail("writer must be 'stream' or 'io_uring', got '" + std::string(name) + "'");
+}
+
+// Non-negative integer that fits T
+template <typename T>
+T checked_unsigned(int64_t value, const std::string& what) {
+    if (value < 0 || static_cast<uint64_t>(value) > std::numeric_limits<T>::max()) {
+        fail(what + " must be between 0 and " + std::to_string(std::numeric_limits<T>::max()));
+    }
+    return static_cast<T>(value);
+}
+
+constexpr uint64_t MB = 1024 * 1024;
+
+// Upper bound for ring_capacity, 16M slots is already several GB of ticks
+constexpr size_t MAX_RING_CAPACITY = size_t{1} << 24;
+
+// Checked before the cast, a negative value would wrap to a huge power of two
+size_t checked_capacity(int64_t value, const std::string& what) {
+    if (value <= 0) fail(what + " must be positive, got " + std::to_string(value));
+    return static_cast<size_t>(value);
+}
+
+uint32_t read_uint32(simdjson::dom::element value, const std::string& key) {
+    return checked_unsigned<uint32_t>(read_int(value, key), "'" + key + "'");
+}
+
+bool read_bool(simdjson::dom::element value, const std::string& key) {
+    bool flag;
+    if (value.get_bool().get(flag)) fail("'" + key + "' must be a boolean");
+    return flag;
+}
+
+SinkConfig read_sink(simdjson::dom::element value) {
+    SinkConfig sink;
+    simdjson::dom::object object;
+    if (value.get_object().get(object)) fail("'sinks' entries must be objects");
+    for (auto field : object) {
+        if (field.key == "type") sink.type = read_string(field.value, "sinks.type");
+        else if (field.key == "path") sink.path = read_string(field.value, "sinks.path");
+        else if (field.key == "lag_policy") sink.lag_policy = parse_lag_policy(read_string(field.value, "sinks.lag_policy"));
+        else if (field.key == "thread") sink.thread = read_thread(field.value, "sinks.thread");
+        else if (field.key == "open_mode") sink.output.open_mode = parse_open_mode(read_string(field.value, "sinks.open_mode"));
+        else if (field.key == "rotate_mb") sink.output.max_bytes = read_uint32(field.value, "sinks.rotate_mb") * MB;
+        else if (field.key == "rotate_interval_s") sink.output.interval_s = read_uint32(field.value, "sinks.rotate_interval_s");
+        else if (field.key == "compress") sink.output.compress = read_bool(field.value, "sinks.compress");
+        else if (field.key == "writer") sink.output.writer = parse_writer(read_string(field.value, "sinks.writer"));
+        else if (field.key == "direct_io") sink.output.direct_io = read_bool(field.value, "sinks.direct_io");
+        else fail("unknown key 'sinks." + std::string(field.key) + "'");
+    }
+    return sink;
+}
+
+// Value of a "--name value" option, advancing i
+std::string option_value(int argc, char* argv[], int& i) {
+    if (i + 1 >= argc) fail(std::string("missing value for ") + argv[i]);
+    return argv[++i];
+}
+
+int64_t parse_int(const std::string& str, const std::string& option) {
+    try {
+        size_t used = 0;
+        int64_t value = std::stoll(str, &used);
+        if (used == str.size()) return value;
+    } catch (const std::exception&) {
+    }
+    fail(option + " expects an integer, got '" + str + "'");
+}
+
+double parse_double(const std::string& str, const std::string& option) {
+    try {
+        size_t used = 0;
+        double value = std::stod(str, &used);
+        if (used == str.size()) return value;
+    } catch (const std::exception&) {
+    }
+    fail(option + " expects a number, got '" + str + "'");
+}
+
+int parse_cpu(const std::string& str, const std::string& option) {
+    if (str == "auto") return AUTO_ISOLATED_CPU;
+    return static_cast<int>(parse_int(str, option));
+}
+
+SinkConfig* find_sink(AppConfig& config, const std::string& type) {
+    for (auto& sink : config.sinks) {
+        if (sink.type == type) return &sink;
+    }
+    return nullptr;
+}
+
+void check_thread(const ThreadPlacement& thread, const std::string& what) {
+    int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    if (thread.cpu != AUTO_ISOLATED_CPU && (thread.cpu < -1 || (cpus > 0 && thread.cpu >= cpus))) {
+        fail(what + " cpu " + std::to_string(thread.cpu) + " is out of range (0.." + std::to_string(cpus - 1) + ", -1 or auto)");
+    }
+    if (thread.rt_priority < 0 || thread.rt_priority > 99) {
+        fail(what + " rt_priority must be 0 (normal) or 1-99 (SCHED_FIFO)");
+    }
+}
+
+}
+
+AppConfig ConfigReader::from_file(const std::string& path) {
+    simdjson::dom::parser parser;
+    simdjson::dom::element root;
+    if (auto error = parser.load(path).get(root)) {
+        fail("cannot read " + path + ": " + simdjson::error_message(error));
+    }
+
+    simdjson::dom::object object;
+    if (root.get_object().get(object)) fail(path + " must contain a JSON object");
+
+    AppConfig config;
+    for (auto field : object) {
+        std::string key(field.key);
+        if (key == "uri") {
+            config.uri = read_string(field.value, key);
+        } else if (key == "products") {
+            config.products = read_string_list(field.value, key);
+        } else if (key == "channels") {
+            config.channels = read_string_list(field.value, key);
+        } else if (key == "ema_period_s") {
+            if (field.value.get_double().get(config.ema_period_s)) fail("'ema_period_s' must be a number");
+        } else if (key == "tick_profile") {
+            config.tick_profile = parse_tick_profile(read_string(field.value, key));
+        } else if (key == "ring_capacity") {
+            config.ring_capacity = checked_capacity(read_int(field.value, key), "'" + key + "'");
+        } else if (key == "wait_strategy") {
+            if (!parse_wait_strategy(read_string(field.value, key), config.wait_strategy)) {
+                fail("wait_strategy must be 'sleep', 'yield' or 'spin'");
+            }
+        } else if (key == "sinks") {
+            simdjson::dom::array sinks;
+            if (field.value.get_array().get(sinks)) fail("'sinks' must be an array");
+            config.sinks.clear();
+            for (simdjson::dom::element sink : sinks) {
+                config.sinks.push_back(read_sink(sink));
+            }
+        } else if (key == "io_thread") {
+            config.io_thread = read_thread(field.value, key);
+        } else if (key == "lock_memory") {
+            if (field.value.get_bool().get(config.lock_memory)) fail("'lock_memory' must be a boolean");
+        } else if (key == "snapshot_path") {
+            config.snapshot_path = read_string(field.value, key);
+        } else if (key == "snapshot_interval_s") {
+            if (field.value.get_double().get(config.snapshot_interval_s)) fail("'snapshot_interval_s' must be a number");
+        } else if (key == "snapshot_max_age_s") {
+            if (field.value.get_double().get(config.snapshot_max_age_s)) fail("'snapshot_max_age_s' must be a number");
+        } else if (key == "drain_timeout_ms") {
+            config.drain_timeout_ms = read_int(field.value, key);
+        } else if (key == "stale_feed_s") {
+            if (field.value.get_double().get(config.stale_feed_s)) fail("'stale_feed_s' must be a number");
+        } else if (key == "max_feed_lag_ms") {
+            if (field.value.get_double().get(config.max_feed_lag_ms)) fail("'max_feed_lag_ms' must be a number");
+        } else {
+            fail("unknown key '" + key + "' in " + path);
+        }
+    }
+    return config;
+}
+
+void ConfigReader::apply_overrides(AppConfig& config, int argc, char* argv[]) {
+    // Output options apply to every sink, including ones added by later options
+    std::optional<OpenMode> open_mode;
+    std::optional<uint64_t> rotate_bytes;
+    std::optional<uint32_t> rotate_interval_s;
+    bool compress = false;
+    std::optional<FileWriter> writer;
+    bool direct_io = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--config") {
+            ++i; // handled by load()
+        } else if (option == "--uri") {
+            config.uri = option_value(argc, argv, i);
+        } else if (option == "--products") {
+            config.products = split_list(option_value(argc, argv, i));
+        } else if (option == "--channels") {
+            config.channels = split_list(option_value(argc, argv, i));
+        } else if (option == "--ema-period") {
+            config.ema_period_s = parse_double(option_value(argc, argv, i), option);
+        } else if (option == "--snapshot") {
+            config.snapshot_path = option_value(argc, argv, i);
+        } else if (option == "--no-snapshot") {
+            config.snapshot_path.clear();
+        } else if (option == "--snapshot-interval") {
+            config.snapshot_interval_s = parse_double(option_value(argc, argv, i), option);
+        } else if (option == "--snapshot-max-age") {
+            config.snapshot_max_age_s = parse_double(option_value(argc, argv, i), option);
+        } else if (option == "--drain-timeout") {
+            config.drain_timeout_ms = parse_int(option_value(argc, argv, i), option);
+        } else if (option == "--stale-after") {
+            config.stale_feed_s = parse_double(option_value(argc, argv, i), option);
+        } else if (option == "--max-lag") {
+            config.max_feed_lag_ms = parse_double(option_value(argc, argv, i), option);
+        } else if (option == "--tick-profile") {
+            config.tick_profile = parse_tick_profile(option_value(argc, argv, i));
+        } else if (option == "--ring-capacity") {
+            config.ring_capacity = checked_capacity(parse_int(option_value(argc, argv, i), option), option);
+        } else if (option == "--wait") {
+            if (!parse_wait_strategy(option_value(argc, argv, i), config.wait_strategy)) {
+                fail("--wait expects 'sleep', 'yield' or 'spin'");
+            }
+        } else if (option == "--csv" || option == "--bars" || option == "--conflated" || option == "--shm") {
+            std::string type = option == "--csv" ? "csv" : option == "--bars" ? "bars_csv"
+                             : option == "--conflated" ? "conflated_csv" : "shm";
+            std::string path = option_value(argc, argv, i);
+            if (SinkConfig* sink = find_sink(config, type)) {
+                sink->path = path;
+            } else {
+                config.sinks.push_back({type, path, LagPolicy::Block, {}, {}});
+            }
+        } else if (option == "--io-cpu") {
+            config.io_thread.cpu = parse_cpu(option_value(argc, argv, i), option);
+        } else if (option == "--io-priority") {
+            config.io_thread.rt_priority = static_cast<int>(parse_int(option_value(argc, argv, i), option));
+        } else if (option == "--lock-memory") {
+            config.lock_memory = true;
+        } else if (option == "--open-mode") {
+            open_mode = parse_open_mode(option_value(argc, argv, i));
+        } else if (option == "--rotate-mb") {
+            rotate_bytes = checked_unsigned<uint32_t>(parse_int(option_value(argc, argv, i), option), option) * MB;
+        } else if (option == "--rotate-interval") {
+            rotate_interval_s = checked_unsigned<uint32_t>(parse_int(option_value(argc, argv, i), option), option);
+        } else if (option == "--compress") {
+            compress = true;
+        } else if (option == "--writer") {
+            writer = parse_writer(option_value(argc, argv, i));
+        } else if (option == "--direct-io") {
+            direct_io = true;
+        } else {
+            fail("unknown option '" + option + "'\n" + usage());
+        }
+    }
+
+    for (auto& sink : config.sinks) {
+        if (sink.type == "shm") continue;  // not a file
+        if (open_mode) sink.output.open_mode = *open_mode;
+        if (rotate_bytes) sink.output.max_bytes = *rotate_bytes;
+        if (rotate_interval_s) sink.output.interval_s = *rotate_interval_s;
+        if (compress) sink.output.compress = true;
+        if (writer) sink.output.writer = *writer;
+        if (direct_io) sink.output.direct_io = true;
+    }
+}
+
+void ConfigReader::validate(const AppConfig& config) {
+    if (config.uri.rfind("ws://", 0) != 0 && config.uri.rfind("wss://", 0) != 0) {
+        fail("uri must start with ws:// or wss://");
+    }
+
+    if (config.products.empty()) fail("at least one product is required");
+    for (size_t i = 0; i < config.products.size(); ++i) {
+        const std::string& product = config.products[i];
+        // Must fit Tick::product_id including the terminator
+        if (product.empty() || product.size() >= sizeof(Tick::product_id)) {
+            fail("product id '" + product + "' must be 1-" + std::to_string(sizeof(Tick::product_id) - 1) + " characters");
+        }
+        if (std::find(config.products.begin(), config.products.begin() + i, product) != config.products.begin() + i) {
+            fail("duplicate product '" + product + "'");
+        }
+    }
+
+    if (config.channels.empty()) fail("at least one channel is required");
+    for (const auto& channel : config.channels) {
+        if (std::find(KNOWN_CHANNELS.begin(), KNOWN_CHANNELS.end(), channel) == KNOWN_CHANNELS.end()) {
+            fail("unknown channel '" + channel + "'");
+        }
+    }
+
+    if (!(config.ema_period_s > 0.0)) fail("ema_period_s must be positive");
+    if (!(config.stale_feed_s > 0.0)) fail("stale_feed_s must be positive");
+    if (config.drain_timeout_ms < 0) fail("drain_timeout_ms must not be negative");
+    if (!(config.snapshot_interval_s > 0.0)) fail("snapshot_interval_s must be positive");
+    if (!(config.snapshot_max_age_s > 0.0)) fail("snapshot_max_age_s must be positive");
+    if (!(config.max_feed_lag_ms > 0.0)) fail("max_feed_lag_ms must be positive");
+
+    if (config.ring_capacity < 2 || (config.ring_capacity & (config.ring_capacity - 1)) != 0) {
+        fail("ring_capacity must be a power of two >= 2, got " + std::to_string(config.ring_capacity));
+    }
+    if (config.ring_capacity > MAX_RING_CAPACITY) {
+        fail("ring_capacity must be at most " + std::to_string(MAX_RING_CAPACITY) + ", got " +
+             std::to_string(config.ring_capacity));
+    }
+
+    size_t tick_sinks = 0;
+    size_t bar_sinks = 0;
+    size_t conflated_sinks = 0;
+    size_t shm_sinks = 0;
+    for (const auto& sink : config.sinks) {
+        if (sink.type == "csv") ++tick_sinks;
+        else if (sink.type == "bars_csv") ++bar_sinks;
+        else if (sink.type == "conflated_csv") ++conflated_sinks;
+        else if (sink.type == "shm") ++shm_sinks;
+        else fail("unknown sink type '" + sink.type + "'");
+        if (sink.path.empty()) fail(sink.type + " sink needs a path");
+        check_thread(sink.thread, sink.type + " sink");
+        if (sink.output.compress && !sink.output.segmented()) {
+            fail(sink.type + " sink: compress needs rotate_mb, rotate_interval_s or open_mode 'new_segment'");
+        }
+        if (sink.output.direct_io && sink.output.writer != FileWriter::IoUring) {
+            fail(sink.type + " sink: direct_io needs the io_uring writer");
+        }
+    }
+    if (tick_sinks + bar_sinks + conflated_sinks + shm_sinks == 0) fail("at least one sink is required");
+    if (tick_sinks > TickBroadcastRing::MAX_CONSUMERS) {
+        fail("at most " + std::to_string(TickBroadcastRing::MAX_CONSUMERS) + " tick sinks are supported");
+    }
+    if (bar_sinks > 1) fail("at most one bars_csv sink is supported");
+    if (conflated_sinks > 1) fail("at most one conflated_csv sink is supported");
+    if (conflated_sinks == 1 && config.products.size() > ConflatingBuffer<Tick>::MAX_PRODUCTS) {
+        fail("conflated_csv supports at most " + std::to_string(ConflatingBuffer<Tick>::MAX_PRODUCTS) + " products");
+    }
+    if (shm_sinks > 1) fail("at most one shm sink is supported");
+    for (const auto& sink : config.sinks) {
+        if (sink.type != "shm") continue;
+        // POSIX shared memory names are "/name" without further slashes
+        if (sink.path.size() < 2 || sink.path[0] != '/' || sink.path.find('/', 1) != std::string::npos) {
+            fail("shm sink path must look like '/sparkland-ticks', got '" + sink.path + "'");
+        }
+        if (config.products.size() > SHM_BUS_MAX_PRODUCTS) {
+            fail("shm sink supports at most " + std::to_string(SHM_BUS_MAX_PRODUCTS) + " products");
+        }
+    }
+
+    bool has_matches = std::find(config.channels.begin(), config.channels.end(), "matches") != config.channels.end();
+    if (bar_sinks == 1 && !has_matches) fail("bars_csv sink needs the 'matches' channel");
+    if (bar_sinks == 0 && has_matches) fail("'matches' channel needs a bars_csv sink");
+
+    check_thread(config.io_thread, "io_thread");
+}
+
+AppConfig ConfigReader::load(int argc, char* argv[]) {
+    AppConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--config") {
+            config = from_file(option_value(argc, argv, i));
+        }
+    }
+    apply_overrides(config, argc, argv);
+    validate(config);
+    return config;
+}
+
+std::string ConfigReader::usage() {
+    std::ostringstream oss;
+    oss << "Usage: sparkland_app [options]\n"
+        << "  --config <file>         JSON config file (see config/sparkland.json)\n"
+        << "  --uri <uri>             websocket feed URI\n"
+        << "  --products <a,b,...>    product ids to subscribe\n"
+        << "  --channels <a,b,...>    ticker, level2, level2_batch, matches\n"
+        << "  --ema-period <seconds>  EMA time period\n"
+        << "  --tick-profile <name>   ticker fields: full, slim (price, bid/ask, sizes, sequence)\n"
+        << "  --ring-capacity <n>     tick ring slots (power of two, at most 16777216)\n"
+        << "  --wait <strategy>       sink idle strategy: sleep, yield, spin\n"
+        << "  --csv <file>            tick CSV path\n"
+        << "  --bars <file>           bar CSV path\n"
+        << "  --conflated <file>      CSV of the latest tick per product, conflated under load\n"
+        << "  --shm <name>            shared memory tick bus for other processes, e.g. /sparkland-ticks\n"
+        << "  --open-mode <mode>      existing output: append (default), new_segment\n"
+        << "  --rotate-mb <n>         start a new segment every n MB\n"
+        << "  --rotate-interval <s>   start a new segment every s seconds (aligned to UTC)\n"
+        << "  --compress              gzip closed segments in the background\n"
+        << "  --writer <name>         file writes: stream (default), io_uring\n"
+        << "  --direct-io             O_DIRECT for the io_uring writer\n"
+        << "  --io-cpu <n|auto>       pin the I/O + parser thread to a CPU (auto: next isolated CPU)\n"
+        << "  --io-priority <1-99>    run the I/O + parser thread SCHED_FIFO\n"
+        << "  --lock-memory           mlockall and prefault the rings at startup\n"
+        << "  --snapshot <file>       warm restart state file (default: off)\n"
+        << "  --no-snapshot           start cold, don't write snapshots\n"
+        << "  --snapshot-interval <s> seconds between snapshots (default 1)\n"
+        << "  --snapshot-max-age <s>  ignore older snapshots at startup (default 60)\n"
+        << "  --drain-timeout <ms>    shutdown bound for the sinks to write and sync (default 2000)\n"
+        << "  --stale-after <s>       warn when a product has no tick for s seconds (default 5)\n"
+        << "  --max-lag <ms>          or its exchange-to-local lag exceeds ms (default 2000)\n"
+        << "  --help                  show this message\n";
+    return oss.str();
+}
+
+}
@@ -1,75 +1,211 @@
 #include "sparkland/csv_logger.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/logger.h"
 #include <iostream>
 #include <limits>
 #include <iomanip>
+#include <ctime>
 
 namespace sparkland {
 
-CSVLogger::CSVLogger(TickRingBuffer& ring_buffer, const std::string& filename)
-    : m_ring_buffer(ring_buffer), m_file(filename, std::ios::out | std::ios::trunc)
-{
-    if (!m_file.is_open()) {
-        throw std::runtime_error("Failed to open CSV file: " + filename);
+namespace {
+
+// Tick columns follow the tick's field mask, the full tick keeps the original column order
+template <uint32_t Fields>
+void write_header(std::ostream& file, const BasicTick<Fields>*) {
+    using T = BasicTick<Fields>;
+    if constexpr (T::has(tick_fields::TYPE)) file << "type,";
+    if constexpr (T::has(tick_fields::SEQUENCE)) file << "sequence,";
+    file << "product_id,price,";
+    if constexpr (T::has(tick_fields::STATS_24H)) file << "open_24h,volume_24h,low_24h,high_24h,volume_30d,";
+    file << "best_bid,best_bid_size,best_ask,best_ask_size,";
+    if constexpr (T::has(tick_fields::SIDE)) file << "side,";
+    if constexpr (T::has(tick_fields::TIME)) file << "time,";
+    if constexpr (T::has(tick_fields::TRADE_ID)) file << "trade_id,";
+    if constexpr (T::has(tick_fields::LAST_SIZE)) file << "last_size,";
+    file << "price_ema,mid_price_ema";
+    if constexpr (T::has(tick_fields::WINDOW_STATS)) {
+        for (uint32_t window_s : STATS_WINDOWS_S) {
+            file << ",vwap_" << window_s << "s,volatility_" << window_s << "s,spread_" << window_s
+                 << "s,tick_count_" << window_s << "s";
+        }
+    }
+    if constexpr (T::has(tick_fields::RECEIVE_TIME)) file << ",receive_time";
+    file << "\n";
+}
+
+template <uint32_t Fields>
+void write_row(std::ostream& file, const BasicTick<Fields>& tick) {
+    using T = BasicTick<Fields>;
+    if constexpr (T::has(tick_fields::TYPE)) file << tick.type << ",";
+    if constexpr (T::has(tick_fields::SEQUENCE)) file << tick.sequence << ",";
+    file << tick.product_id << ","
+         << tick.price << ",";
+    if constexpr (T::has(tick_fields::STATS_24H)) {
+        file << tick.open_24h << ","
+             << tick.volume_24h << ","
+             << tick.low_24h << ","
+             << tick.high_24h << ","
+             << tick.volume_30d << ",";
+    }
+    file << tick.best_bid << ","
+         << tick.best_bid_size << ","
+         << tick.best_ask << ","
+         << tick.best_ask_size << ",";
+    if constexpr (T::has(tick_fields::SIDE)) file << tick.side << ",";
+    if constexpr (T::has(tick_fields::TIME)) file << tick.time << ",";
+    if constexpr (T::has(tick_fields::TRADE_ID)) file << tick.trade_id << ",";
+    if constexpr (T::has(tick_fields::LAST_SIZE)) file << tick.last_size << ",";
+    file << tick.price_ema << ","
+         << tick.mid_price_ema;
+    if constexpr (T::has(tick_fields::WINDOW_STATS)) {
+        for (const WindowStat& stat : tick.window_stats) {
+            file << "," << stat.vwap
+                 << "," << stat.volatility
+                 << "," << stat.mean_spread
+                 << "," << stat.tick_count;
+        }
     }
+    // Same format as time (ns precision), so the two compare directly
+    if constexpr (T::has(tick_fields::RECEIVE_TIME)) file << "," << format_exchange_time(tick.receive_time_ns, 9);
+    file << "\n";
+}
+
+void write_header(std::ostream& file, const Bar*) {
+    file << "product_id,interval_s,start,open,high,low,close,volume,vwap,trade_count\n";
+}
+
+void write_row(std::ostream& file, const Bar& bar) {
+    // Bar start as ISO-8601 UTC, e.g. 2025-09-07T08:47:00Z
+    std::time_t start = static_cast<std::time_t>(bar.start_us / 1000000);
+    std::tm utc{};
+    gmtime_r(&start, &utc);
+    char start_str[32];
+    std::strftime(start_str, sizeof(start_str), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+    file << bar.product_id << ","
+         << bar.interval_s << ","
+         << start_str << ","
+         << bar.open << ","
+         << bar.high << ","
+         << bar.low << ","
+         << bar.close << ","
+         << bar.volume << ","
+         << bar.vwap << ","
+         << bar.trade_count
+         << "\n";
+}
+
+}
+
+template <typename Source>
+BasicCSVLogger<Source>::BasicCSVLogger(Source& ring_buffer, const std::string& filename,
+                                       WaitStrategy wait_strategy, const OutputPolicy& output,
+                                       SegmentCompressor* compressor)
+    : m_ring_buffer(ring_buffer), m_output(filename, output, compressor),
+      m_wait_strategy(wait_strategy)
+{
+    start_segment();
+}
 
-    // Write header row
-    m_file << "type,sequence,product_id,price,open_24h,volume_24h,low_24h,high_24h,"
-           << "volume_30d,best_bid,best_bid_size,best_ask,best_ask_size,side,time,trade_id,last_size,price_ema,mid_price_ema\n";
+template <typename Source>
+BasicCSVLogger<Source>::~BasicCSVLogger() {
+    // Not a drain: the source may never see an end of stream here (exception, early return),
+    // the writer stops where it is and syncs what it wrote. Call stop() first to drain
+    stop(std::chrono::steady_clock::now());
 }
 
-CSVLogger::~CSVLogger() {
-    stop();
-    if (m_file.is_open()) {
-        m_file.close();
+template <typename Source>
+void BasicCSVLogger<Source>::start_segment() {
+    m_output.stream() << std::setprecision(std::numeric_limits<double>::digits10 + 1);
+
+    // Header row, only for a new (empty) file or segment
+    if (m_output.needs_header()) {
+        write_header(m_output.stream(), static_cast<const Record*>(nullptr));
+        m_output.header_written();
     }
 }
 
-void CSVLogger::start() {
-    m_running = true;
-    m_thread = std::thread(&CSVLogger::run, this);
+template <typename Source>
+void BasicCSVLogger<Source>::start() {
+    m_thread = std::thread(&BasicCSVLogger::run, this);
 }
 
-void CSVLogger::stop() {
-    m_running = false;
-    if (m_thread.joinable()) {
-        m_thread.join();
+template <typename Source>
+DrainStats BasicCSVLogger<Source>::stop(std::chrono::steady_clock::time_point deadline) {
+    if (!m_thread.joinable()) return m_stats;
+
+    auto stop_start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_finished_cv.wait_until(lock, deadline, [this]() { return m_finished; })) {
+            // Deadline passed before the end of stream, the writer syncs what it has and exits
+            m_abort.store(true, std::memory_order_relaxed);
+        }
     }
+    m_thread.join();
+
+    // Producer is gone by now, whatever is left in the source will never be written
+    m_stats.abandoned = m_ring_buffer.size();
+    m_stats.drain_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stop_start).count();
+    return m_stats;
 }
 
-void CSVLogger::run() {
-    m_file << std::setprecision(std::numeric_limits<double>::digits10 + 1);
-    while (m_running || !m_ring_buffer.empty()) {
-        Tick* tick = m_ring_buffer.acquire_filled_slot();
-        if (tick) {
-            // Write Tick to CSV
-            m_file << tick->type << ","
-                   << tick->sequence << ","
-                   << tick->product_id << ","
-                   << tick->price << ","
-                   << tick->open_24h << ","
-                   << tick->volume_24h << ","
-                   << tick->low_24h << ","
-                   << tick->high_24h << ","
-                   << tick->volume_30d << ","
-                   << tick->best_bid << ","
-                   << tick->best_bid_size << ","
-                   << tick->best_ask << ","
-                   << tick->best_ask_size << ","
-                   << tick->side << ","
-                   << tick->time << ","
-                   << tick->trade_id << ","
-                   << tick->last_size << ","
-                   << tick->price_ema << ","
-                   << tick->mid_price_ema
-                   << "\n";
-            
-            // Return slot to free state
-            m_ring_buffer.release_slot();
+template <typename Source>
+void BasicCSVLogger<Source>::run() {
+    apply_thread_placement(m_placement);
+    prefault_stack();
+
+    uint64_t written = 0;
+    uint64_t torn = 0;
+    while (!m_abort.load(std::memory_order_relaxed)) {
+        Record* record = m_ring_buffer.acquire_filled_slot();
+        if (record) {
+            if constexpr (std::is_same_v<decltype(m_ring_buffer.release_slot()), bool>) {
+                // A Drop consumer's slot can be overwritten while it is read: copy it out and
+                // only write the copy if the slot was still intact when it was released
+                std::remove_const_t<Record> copy = *record;
+                if (!m_ring_buffer.release_slot()) {
+                    ++torn;
+                    continue;
+                }
+                write_row(m_output.stream(), copy);
+            } else {
+                write_row(m_output.stream(), *record);
+
+                // Return slot to free state
+                m_ring_buffer.release_slot();
+            }
+            ++written;
+
+            if (m_output.record_written()) start_segment();
         } else {
-            // Avoid busy spinning — short sleep
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            // Nothing before the end of stream marker is left
+            if (m_ring_buffer.drained()) break;
+
+            // Nothing to write, idle according to the configured strategy
+            if (m_output.idle()) start_segment();
+            idle(m_wait_strategy);
         }
     }
+
+    bool reached_end = m_ring_buffer.drained();
+    bool synced = m_output.close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.written = written;
+    m_stats.torn = torn;
+    m_stats.reached_end = reached_end;
+    m_stats.synced = synced;
+    m_finished = true;
+    m_finished_cv.notify_one();
 }
 
+template class BasicCSVLogger<TickRingBuffer>;
+template class BasicCSVLogger<TickBroadcastRing::Consumer>;
+template class BasicCSVLogger<SlimTickBroadcastRing::Consumer>;
+template class BasicCSVLogger<ConflatingBuffer<Tick>::Reader>;
+template class BasicCSVLogger<ConflatingBuffer<SlimTick>::Reader>;
+template class BasicCSVLogger<BarRingBuffer>;
+
 }
@@ -0,0 +1,110 @@
+#include "sparkland/feed_latency.h"
+
+#include <sys/timex.h>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <limits>
+
+namespace sparkland {
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int64_t days_from_civil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+}
+
+int64_t wall_clock_ns() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<int64_t>(now.tv_sec) * NS_PER_SECOND + now.tv_nsec;
+}
+
+std::string format_exchange_time(int64_t epoch_ns, int fraction_digits) {
+    std::time_t seconds = static_cast<std::time_t>(epoch_ns / NS_PER_SECOND);
+    int64_t fraction = epoch_ns % NS_PER_SECOND;
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    char buffer[48];
+    size_t len = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+    if (fraction_digits > 0) {
+        for (int i = fraction_digits; i < 9; ++i) fraction /= 10;
+        len += static_cast<size_t>(std::snprintf(buffer + len, sizeof(buffer) - len, ".%0*lld",
+                                                 fraction_digits, static_cast<long long>(fraction)));
+    }
+    std::snprintf(buffer + len, sizeof(buffer) - len, "Z");
+    return buffer;
+}
+
+int64_t parse_exchange_time(std::string_view str) {
+    // YYYY-MM-DDTHH:MM:SS then an optional fraction and Z
+    if (str.size() < 20 || str[4] != '-' || str[7] != '-' || str[10] != 'T' || str[13] != ':' ||
+        str[16] != ':' || str.back() != 'Z') {
+        return -1;
+    }
+    int64_t fields[6];
+    constexpr size_t POSITIONS[6] = {0, 5, 8, 11, 14, 17};
+    constexpr size_t WIDTHS[6] = {4, 2, 2, 2, 2, 2};
+    for (size_t f = 0; f < 6; ++f) {
+        int64_t value = 0;
+        for (size_t i = POSITIONS[f]; i < POSITIONS[f] + WIDTHS[f]; ++i) {
+            if (str[i] < '0' || str[i] > '9') return -1;
+            value = value * 10 + (str[i] - '0');
+        }
+        fields[f] = value;
+    }
+    if (fields[1] < 1 || fields[1] > 12 || fields[2] < 1 || fields[2] > 31) return -1;
+
+    // Fraction of any precision, digits past ns are ignored
+    int64_t fraction_ns = 0;
+    if (str.size() > 20) {
+        if (str[19] != '.') return -1;
+        int64_t scale = NS_PER_SECOND / 10;
+        for (size_t i = 20; i + 1 < str.size(); ++i) {
+            if (str[i] < '0' || str[i] > '9') return -1;
+            fraction_ns += (str[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    int64_t days = days_from_civil(fields[0], static_cast<int>(fields[1]), static_cast<int>(fields[2]));
+    int64_t seconds = days * 86400 + fields[3] * 3600 + fields[4] * 60 + fields[5];
+    // ns since the epoch only cover 1970 to 2262
+    if (seconds < 0 || seconds >= std::numeric_limits<int64_t>::max() / NS_PER_SECOND) return -1;
+    return seconds * NS_PER_SECOND + fraction_ns;
+}
+
+ClockSyncStatus clock_sync_status() {
+    ClockSyncStatus status;
+    timex tx{};  // modes 0: read only, no privileges needed
+    int state = ntp_adjtime(&tx);
+    if (state == -1) return status;
+    status.synchronized = state != TIME_ERROR && !(tx.status & STA_UNSYNC);
+    status.estimated_error_ns = static_cast<int64_t>(tx.esterror) * 1000;
+    status.max_error_ns = static_cast<int64_t>(tx.maxerror) * 1000;
+    return status;
+}
+
+FeedLatencyMonitor::FeedLatencyMonitor(const std::vector<std::string>& product_ids, int64_t stale_after_ns,
+                                       int64_t max_lag_ns)
+    : m_products(new Product[product_ids.size()]), m_size(product_ids.size()),
+      m_stale_after_ns(stale_after_ns), m_max_lag_ns(max_lag_ns) {
+    // Products that never tick go stale stale_after_ns after startup
+    int64_t now_ns = wall_clock_ns();
+    for (size_t i = 0; i < m_size; ++i) {
+        m_products[i].id = product_ids[i];
+        m_products[i].last_receive_ns.store(now_ns, std::memory_order_relaxed);
+    }
+}
+
+}
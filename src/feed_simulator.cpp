@@ -0,0 +1,157 @@
+#include "sparkland/feed_simulator.h"
+#include "sparkland/feed_latency.h"
+
+#include <websocketpp/common/asio.hpp>
+#include <websocketpp/common/asio_ssl.hpp>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace sparkland {
+
+template <typename Config>
+BasicFeedSimulator<Config>::BasicFeedSimulator(const FeedProfile& profile, uint16_t port, const TlsFiles& tls)
+    : m_profile(profile), m_port(port), m_tls(tls), m_generator(profile),
+      m_total(profile.duration_s > 0 ? static_cast<uint64_t>(profile.duration_s * profile.rate) : 0),
+      m_logger(Logger::getInstance()) {
+    if (m_profile.burst == 0) m_profile.burst = 1;
+
+    m_server.clear_access_channels(websocketpp::log::alevel::all);
+    m_server.init_asio();
+    m_server.set_reuse_addr(true);
+    m_timer = std::make_unique<Timer>(m_server.get_io_service());
+
+    if constexpr (std::is_same_v<Config, websocketpp::config::asio_tls>) {
+        m_server.set_tls_init_handler([this](websocketpp::connection_hdl) {
+            namespace ssl = websocketpp::lib::asio::ssl;
+            auto ctx = websocketpp::lib::make_shared<ssl::context>(ssl::context::sslv23);
+            try {
+                ctx->set_options(ssl::context::default_workarounds | ssl::context::no_sslv2 |
+                                 ssl::context::no_sslv3 | ssl::context::single_dh_use);
+                ctx->use_certificate_chain_file(m_tls.certificate_chain);
+                ctx->use_private_key_file(m_tls.private_key, ssl::context::pem);
+            } catch (std::exception& e) {
+                m_logger.error(std::string("Simulator TLS initialization error: ") + e.what());
+            }
+            return ctx;
+        });
+    }
+    m_server.set_message_handler([this](websocketpp::connection_hdl hdl, typename Server::message_ptr msg) {
+        on_message(hdl, msg);
+    });
+    m_server.set_close_handler([this](websocketpp::connection_hdl hdl) { on_close(hdl); });
+    m_server.set_fail_handler([this](websocketpp::connection_hdl hdl) { on_close(hdl); });
+}
+
+template <typename Config>
+BasicFeedSimulator<Config>::~BasicFeedSimulator() {
+    stop();
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::start() {
+    if (m_running.exchange(true)) return;
+
+    try {
+        m_server.listen(m_port);
+        m_server.start_accept();
+    } catch (...) {
+        m_running = false;
+        throw;
+    }
+    m_logger.info("Feed simulator listening on port " + std::to_string(m_port));
+
+    m_thread = std::thread([this]() { m_server.run(); });
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::stop() {
+    if (!m_running.exchange(false)) return;
+
+    // Everything the I/O thread owns is torn down on it, run() returns once the
+    // connections are closed
+    m_server.get_io_service().post([this]() {
+        websocketpp::lib::error_code ec;
+        m_timer->cancel();
+        m_server.stop_listening(ec);
+        for (const auto& hdl : m_subscribers) {
+            m_server.close(hdl, websocketpp::close::status::going_away, "Simulator shutdown", ec);
+        }
+        m_subscribers.clear();
+    });
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_logger.info("Feed simulator sent " + std::to_string(sent()) + " messages");
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::on_message(websocketpp::connection_hdl hdl, typename Server::message_ptr msg) {
+    const std::string& payload = msg->get_payload();
+    if (payload.find("\"subscribe\"") == std::string::npos) return;
+
+    // The products of the feed, whatever was asked for
+    std::string reply = R"({"type":"subscriptions","channels":[{"name":"ticker","product_ids":[)";
+    const auto& products = m_generator.products();
+    for (size_t i = 0; i < products.size(); ++i) {
+        if (i > 0) reply += ",";
+        reply += "\"" + products[i] + "\"";
+    }
+    reply += "]}]}";
+    websocketpp::lib::error_code ec;
+    m_server.send(hdl, reply, websocketpp::frame::opcode::text, ec);
+    m_subscribers.insert(hdl);
+
+    if (!m_streaming) {
+        m_streaming = true;
+        m_stream_start = std::chrono::steady_clock::now();
+        send_due();
+    }
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::on_close(websocketpp::connection_hdl hdl) {
+    m_subscribers.erase(hdl);
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::schedule(std::chrono::steady_clock::time_point when) {
+    m_timer->expires_at(when);
+    m_timer->async_wait([this](const websocketpp::lib::asio::error_code& ec) {
+        if (!ec) send_due();
+    });
+}
+
+template <typename Config>
+void BasicFeedSimulator<Config>::send_due() {
+    // Burst k is due k * burst / rate seconds after the first subscriber
+    const double burst = static_cast<double>(m_profile.burst);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_stream_start).count();
+    uint64_t due = (static_cast<uint64_t>(elapsed * m_profile.rate / burst) + 1) * m_profile.burst;
+    if (m_total > 0) due = std::min(due, m_total);
+
+    uint64_t sent = m_sent.load(std::memory_order_relaxed);
+    if (due - sent > m_profile.burst) m_late_bursts.fetch_add(1, std::memory_order_relaxed);
+
+    websocketpp::lib::error_code ec;
+    for (; sent < due; ++sent) {
+        const std::string& message = m_generator.next(wall_clock_ns());
+        for (const auto& hdl : m_subscribers) {
+            m_server.send(hdl, message, websocketpp::frame::opcode::text, ec);
+            if (ec) m_send_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    m_sent.store(sent, std::memory_order_release);
+
+    if (m_total > 0 && sent >= m_total) {
+        m_finished.store(true, std::memory_order_release);
+        return;
+    }
+    schedule(m_stream_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(sent) / m_profile.rate)));
+}
+
+template class BasicFeedSimulator<websocketpp::config::asio>;
+template class BasicFeedSimulator<websocketpp::config::asio_tls>;
+
+}
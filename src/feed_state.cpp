@@ -0,0 +1,246 @@
+#include "sparkland/feed_state.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/logger.h"
+#include "sparkland/thread_placement.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+namespace sparkland {
+
+namespace {
+
+static_assert(std::is_trivially_copyable<ProductState>::value, "ProductState is written as raw bytes");
+
+constexpr char FEED_STATE_MAGIC[8] = {'S', 'L', 'S', 'T', 'A', 'T', 'E', '\0'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;  // sizeof(ProductState), catches layout changes without a version bump
+    uint64_t product_count;
+    int64_t written_ns;
+    double ema_period_s;
+    uint64_t checksum;     // FNV-1a of the records
+};
+
+uint64_t fnv1a(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool write_all(int fd, const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = ::read(fd, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+bool write_feed_state(const std::string& path, const FeedState& state) {
+    FileHeader header{};
+    std::memcpy(header.magic, FEED_STATE_MAGIC, sizeof(header.magic));
+    header.version = FEED_STATE_VERSION;
+    header.record_size = sizeof(ProductState);
+    header.product_count = state.products.size();
+    header.written_ns = state.written_ns;
+    header.ema_period_s = state.ema_period_s;
+    size_t records_bytes = state.products.size() * sizeof(ProductState);
+    header.checksum = fnv1a(state.products.data(), records_bytes);
+
+    const std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, state.products.data(), records_bytes) &&
+              ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+
+    // The rename itself is only durable once the directory is synced
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+bool read_feed_state(const std::string& path, double ema_period_s, int64_t now_ns, int64_t max_age_ns,
+                     FeedState& out, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "no snapshot at " + path;
+        return false;
+    }
+
+    FileHeader header{};
+    FeedState state;
+    bool complete = read_all(fd, &header, sizeof(header));
+    if (complete && std::memcmp(header.magic, FEED_STATE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == FEED_STATE_VERSION && header.record_size == sizeof(ProductState) &&
+        header.product_count <= 4096) {
+        state.products.resize(header.product_count);
+        complete = read_all(fd, state.products.data(), header.product_count * sizeof(ProductState));
+    }
+    ::close(fd);
+
+    if (!complete) {
+        error = path + " is truncated";
+        return false;
+    }
+    if (std::memcmp(header.magic, FEED_STATE_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + " is not a feed state snapshot";
+        return false;
+    }
+    if (header.version != FEED_STATE_VERSION || header.record_size != sizeof(ProductState)) {
+        error = path + " has version " + std::to_string(header.version) + ", expected " +
+                std::to_string(FEED_STATE_VERSION);
+        return false;
+    }
+    if (state.products.size() != header.product_count ||
+        fnv1a(state.products.data(), state.products.size() * sizeof(ProductState)) != header.checksum) {
+        error = path + " is corrupt (checksum mismatch)";
+        return false;
+    }
+    if (std::fabs(header.ema_period_s - ema_period_s) > 1e-9) {
+        error = path + " was taken with an EMA period of " + std::to_string(header.ema_period_s) + " s";
+        return false;
+    }
+    int64_t age_ns = now_ns - header.written_ns;
+    if (age_ns > max_age_ns) {
+        error = path + " is stale (" + std::to_string(age_ns / 1000000000) + " s old)";
+        return false;
+    }
+
+    state.written_ns = header.written_ns;
+    state.ema_period_s = header.ema_period_s;
+    // Product ids are fixed size fields, make sure they are terminated whatever the file says
+    for (auto& product : state.products) product.product_id[sizeof(product.product_id) - 1] = '\0';
+    out = std::move(state);
+    return true;
+}
+
+FeedStateSnapshotter::FeedStateSnapshotter(std::string path, const std::vector<std::string>& product_ids,
+                                           double ema_period_s, int64_t interval_ns)
+    : m_path(std::move(path)), m_interval_ns(interval_ns),
+      m_staged(product_ids.size()) {
+    for (size_t i = 0; i < product_ids.size(); ++i) {
+        std::snprintf(m_staged[i].product_id, sizeof(m_staged[i].product_id), "%s", product_ids[i].c_str());
+    }
+    // Sized once, copying into it never allocates
+    m_pending.ema_period_s = ema_period_s;
+    m_pending.products = m_staged;
+}
+
+FeedStateSnapshotter::~FeedStateSnapshotter() {
+    stop();
+}
+
+void FeedStateSnapshotter::start() {
+    m_next_ns = wall_clock_ns() + m_interval_ns;
+    m_thread = std::thread(&FeedStateSnapshotter::run, this);
+}
+
+void FeedStateSnapshotter::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+
+    // The parser is gone, the staged state is final
+    m_pending.written_ns = wall_clock_ns();
+    m_pending.products = m_staged;
+    if (write_feed_state(m_path, m_pending)) {
+        ++m_written;
+    } else {
+        ++m_failed;
+        Logger::getInstance().error("Failed to write feed state snapshot " + m_path);
+    }
+}
+
+void FeedStateSnapshotter::offer(int64_t now_ns) {
+    m_next_ns = now_ns + m_interval_ns;
+
+    // Never wait for the writer: if it is busy this snapshot is skipped, the next one comes an interval later
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock() || m_writing) {
+        ++m_skipped;
+        return;
+    }
+    m_pending.written_ns = now_ns;
+    std::copy(m_staged.begin(), m_staged.end(), m_pending.products.begin());
+    m_has_pending = true;
+    lock.unlock();
+    m_cv.notify_one();
+}
+
+void FeedStateSnapshotter::run() {
+    apply_background_priority("sl-snapshot");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this]() { return m_stopping || m_has_pending; });
+        if (!m_has_pending) return;  // stopping, stop() writes the final state
+
+        // The parser leaves m_pending alone while it is written
+        m_has_pending = false;
+        m_writing = true;
+        lock.unlock();
+        bool ok = write_feed_state(m_path, m_pending);
+        lock.lock();
+        m_writing = false;
+
+        if (ok) {
+            ++m_written;
+        } else {
+            ++m_failed;
+            Logger::getInstance().warning("Failed to write feed state snapshot " + m_path);
+        }
+    }
+}
+
+}
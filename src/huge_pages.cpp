@@ -0,0 +1,125 @@
+#include "sparkland/huge_pages.h"
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+
+namespace sparkland {
+
+namespace {
+
+// From <numaif.h>, which is part of libnuma and not always installed
+constexpr int MPOL_PREFERRED_POLICY = 1;
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+void* map_anonymous(size_t bytes, int extra_flags) {
+    void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return addr == MAP_FAILED ? nullptr : addr;
+}
+
+bool bind_to_node(void* addr, size_t bytes, int node) {
+#ifdef SYS_mbind
+    constexpr size_t BITS = sizeof(unsigned long) * 8;
+    if (node < 0 || static_cast<size_t>(node) >= BITS * 16) return false;
+    unsigned long mask[16] = {};
+    mask[node / BITS] = 1UL << (node % BITS);
+    return syscall(SYS_mbind, addr, bytes, MPOL_PREFERRED_POLICY, mask, BITS * 16 + 1, 0) == 0;
+#else
+    (void)addr; (void)bytes; (void)node;
+    return false;
+#endif
+}
+
+}
+
+const char* to_string(PageBacking backing) {
+    switch (backing) {
+        case PageBacking::HugeTlb: return "hugetlb";
+        case PageBacking::TransparentHuge: return "thp";
+        case PageBacking::Regular: return "regular";
+    }
+    return "unknown";
+}
+
+HugePageRegion::HugePageRegion(size_t bytes, int numa_node) : m_size(bytes) {
+    if (bytes == 0) bytes = 1;
+
+    if (bytes >= HUGE_PAGE_THRESHOLD) {
+        m_mapped = round_up(bytes, HUGE_PAGE_SIZE);
+
+        // Explicit huge pages, only available if the admin reserved a pool
+        m_mapping = map_anonymous(m_mapped, MAP_HUGETLB | MAP_HUGE_2MB);
+        if (m_mapping) {
+            m_data = m_mapping;
+            m_mapping_size = m_mapped;
+            m_backing = PageBacking::HugeTlb;
+        } else {
+            // Over-map so a 2 MB aligned range fits, THP only promotes aligned ranges
+            m_mapping_size = m_mapped + HUGE_PAGE_SIZE;
+            m_mapping = map_anonymous(m_mapping_size, MAP_NORESERVE);
+            if (!m_mapping) throw std::bad_alloc();
+            auto base = reinterpret_cast<uintptr_t>(m_mapping);
+            m_data = reinterpret_cast<void*>(round_up(base, HUGE_PAGE_SIZE));
+            m_backing = madvise(m_data, m_mapped, MADV_HUGEPAGE) == 0 ? PageBacking::TransparentHuge
+                                                                      : PageBacking::Regular;
+        }
+    } else {
+        m_mapped = round_up(bytes, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+        m_mapping_size = m_mapped;
+        m_mapping = map_anonymous(m_mapped, 0);
+        if (!m_mapping) throw std::bad_alloc();
+        m_data = m_mapping;
+    }
+
+    // Untouched so far, so every page will come from the preferred node
+    if (numa_node >= 0 && bind_to_node(m_data, m_mapped, numa_node)) {
+        m_numa_node = numa_node;
+    }
+}
+
+HugePageRegion::~HugePageRegion() {
+    if (m_mapping) munmap(m_mapping, m_mapping_size);
+}
+
+int numa_node_of_cpu(int cpu) {
+    if (cpu < 0) return -1;
+    // The cpu directory has a "nodeN" link to its node
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return -1;
+
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+int current_numa_node() {
+    int cpu = sched_getcpu();
+    return cpu < 0 ? -1 : numa_node_of_cpu(cpu);
+}
+
+}
@@ -0,0 +1,245 @@
+#include "sparkland/coinbase_client.h"
+#include "sparkland/csv_logger.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/feed_simulator.h"
+#include "sparkland/latency_histogram.h"
+#include "sparkland/ticker_generator.h"
+#include "sparkland/types.h"
+
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+// Load test of the feed path: a local feed simulator streams ticker messages to
+// BasicCoinbaseClient -> TickParser -> tick ring (-> optional CSV sink) in this process and
+// the sustained throughput, drops and send-to-ring latency percentiles are reported.
+// --serve only runs the simulator, for pointing sparkland_app --uri at it.
+
+namespace {
+
+std::atomic<bool> running{true};
+
+void signal_handler(int) {
+    running = false;
+}
+
+struct LoadTestOptions {
+    sparkland::FeedProfile profile;
+    uint16_t port = 8765;
+    sparkland::TlsFiles tls;   // wss:// when set
+    std::string csv_path;      // CSV sink on the tick ring, none by default
+    size_t ring_capacity = sparkland::TICK_BUFFER_CAPACITY;
+    double drain_timeout_s = 5.0;
+    bool serve = false;
+};
+
+std::string usage() {
+    return "Usage: sparkland_load_test [options]\n"
+           "  --rate <msgs/s>         ticker messages per second (default 10000)\n"
+           "  --burst <n>             messages sent back to back per burst (default 1)\n"
+           "  --products <n>          synthetic products, 1-1000 (default 3)\n"
+           "  --duration <s>          seconds of traffic, 0 streams until Ctrl+C (default 10)\n"
+           "  --seed <n>              synthetic feed seed (default 1)\n"
+           "  --replay <file>         replay recorded messages (one JSON per line) instead\n"
+           "  --port <port>           simulator port (default 8765)\n"
+           "  --tls <cert> <key>      serve wss:// with this PEM certificate chain and key\n"
+           "  --csv <file>            also write the ticks through a CSV sink\n"
+           "  --ring-capacity <n>     tick ring slots, power of two (default 1024)\n"
+           "  --drain-timeout <s>     wait for in-flight ticks after the last send (default 5)\n"
+           "  --serve                 only run the simulator until Ctrl+C\n";
+}
+
+double parse_number(int argc, char* argv[], int& i) {
+    std::string option = argv[i];
+    if (i + 1 >= argc) throw std::invalid_argument(option + " expects a value");
+    try {
+        return std::stod(argv[++i]);
+    } catch (const std::exception&) {
+        throw std::invalid_argument(option + " expects a number, got '" + argv[i] + "'");
+    }
+}
+
+LoadTestOptions parse_options(int argc, char* argv[]) {
+    LoadTestOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--rate") {
+            options.profile.rate = parse_number(argc, argv, i);
+        } else if (option == "--burst") {
+            options.profile.burst = static_cast<uint32_t>(parse_number(argc, argv, i));
+        } else if (option == "--products") {
+            options.profile.product_count = static_cast<uint32_t>(parse_number(argc, argv, i));
+        } else if (option == "--duration") {
+            options.profile.duration_s = parse_number(argc, argv, i);
+        } else if (option == "--seed") {
+            options.profile.seed = static_cast<uint64_t>(parse_number(argc, argv, i));
+        } else if (option == "--replay" && i + 1 < argc) {
+            options.profile.replay_path = argv[++i];
+        } else if (option == "--port") {
+            options.port = static_cast<uint16_t>(parse_number(argc, argv, i));
+        } else if (option == "--tls" && i + 2 < argc) {
+            options.tls.certificate_chain = argv[++i];
+            options.tls.private_key = argv[++i];
+        } else if (option == "--csv" && i + 1 < argc) {
+            options.csv_path = argv[++i];
+        } else if (option == "--ring-capacity") {
+            options.ring_capacity = static_cast<size_t>(parse_number(argc, argv, i));
+        } else if (option == "--drain-timeout") {
+            options.drain_timeout_s = parse_number(argc, argv, i);
+        } else if (option == "--serve") {
+            options.serve = true;
+        } else {
+            throw std::invalid_argument("unknown or incomplete option '" + option + "'\n" + usage());
+        }
+    }
+
+    if (options.profile.rate <= 0) throw std::invalid_argument("--rate must be positive");
+    if (options.profile.burst == 0) throw std::invalid_argument("--burst must be at least 1");
+    if (options.profile.product_count == 0 || options.profile.product_count > sparkland::MAX_SYNTHETIC_PRODUCTS) {
+        throw std::invalid_argument("--products must be between 1 and " +
+                                    std::to_string(sparkland::MAX_SYNTHETIC_PRODUCTS));
+    }
+    if (options.profile.duration_s < 0) throw std::invalid_argument("--duration must not be negative");
+    return options;
+}
+
+template <typename Simulator>
+int serve(Simulator& simulator) {
+    simulator.start();
+    std::cout << "Feed simulator running... (Press Ctrl+C to stop)" << std::endl;
+    while (running && !simulator.finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    simulator.stop();
+    return 0;
+}
+
+template <typename ServerConfig, typename ClientConfig>
+int run_load_test(const LoadTestOptions& options, const std::string& uri) {
+    using Handler = sparkland::BroadcastParserHandler;
+
+    sparkland::BasicFeedSimulator<ServerConfig> simulator(options.profile, options.port, options.tls);
+    if (options.serve) return serve(simulator);
+    const std::vector<std::string>& products = simulator.products();
+
+    // Same pipeline as the application: every tick goes through the ring, the latency
+    // consumer gates it like a sink would
+    sparkland::TickBroadcastRing ring(options.ring_capacity);
+    auto& latency_cursor = ring.add_consumer();
+    std::unique_ptr<sparkland::BroadcastCSVLogger> csv_sink;
+    if (!options.csv_path.empty()) {
+        csv_sink = std::make_unique<sparkland::BroadcastCSVLogger>(ring.add_consumer(), options.csv_path);
+    }
+    sparkland::BroadcastTickParser parser(ring, products);
+    sparkland::BasicCoinbaseClient<Handler, ClientConfig> client(uri, products, {"ticker"}, Handler{&parser});
+
+    sparkland::LatencyHistogram latency;
+    std::atomic<uint64_t> received{0};
+    std::chrono::steady_clock::time_point first_tick;
+    std::chrono::steady_clock::time_point last_tick;
+    std::thread measure([&]() {
+        while (!latency_cursor.drained()) {
+            sparkland::Tick* tick = latency_cursor.acquire_filled_slot();
+            if (!tick) {
+                std::this_thread::yield();
+                continue;
+            }
+            int64_t now_ns = sparkland::wall_clock_ns();
+            int64_t sent_ns = sparkland::parse_exchange_time(tick->time);
+            if (sent_ns >= 0 && now_ns >= sent_ns) latency.record(static_cast<uint64_t>(now_ns - sent_ns));
+            latency_cursor.release_slot();
+
+            last_tick = std::chrono::steady_clock::now();
+            if (received.load(std::memory_order_relaxed) == 0) first_tick = last_tick;
+            received.fetch_add(1, std::memory_order_release);
+        }
+    });
+
+    if (csv_sink) csv_sink->start();
+    simulator.start();
+    client.start();
+
+    while (running && !simulator.finished()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Ticks still in flight: socket buffers, parser, ring
+    auto drain_deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(options.drain_timeout_s));
+    while (running && received.load(std::memory_order_acquire) < simulator.sent() &&
+           std::chrono::steady_clock::now() < drain_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    client.stop();
+    parser.end_of_stream();
+    measure.join();
+    sparkland::DrainStats csv_stats;
+    if (csv_sink) csv_stats = csv_sink->stop();
+    simulator.stop();
+
+    uint64_t sent = simulator.sent();
+    uint64_t ticks = received.load();
+    double elapsed_s = std::chrono::duration<double>(last_tick - first_tick).count();
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Feed:        " << uri << ", " << products.size() << " products, "
+              << options.profile.rate << " msgs/s in bursts of " << options.profile.burst << "\n"
+              << "Sent:        " << sent << " messages, " << simulator.late_bursts() << " late bursts, "
+              << simulator.send_errors() << " send errors\n"
+              << "Received:    " << ticks << " ticks in " << elapsed_s << " s, "
+              << (elapsed_s > 0 ? static_cast<double>(ticks) / elapsed_s : 0.0) << " ticks/s sustained\n"
+              << "Dropped:     " << (sent > ticks ? sent - ticks : 0) << " (parser rejected or ring full: "
+              << client.handler().failed << ")\n"
+              << "Latency us:  p50 " << us(latency.percentile(0.50))
+              << "  p90 " << us(latency.percentile(0.90))
+              << "  p99 " << us(latency.percentile(0.99))
+              << "  p99.9 " << us(latency.percentile(0.999))
+              << "  max " << us(latency.max())
+              << "  (send to ring consumer)" << std::endl;
+    if (csv_sink) {
+        std::cout << "CSV sink:    " << csv_stats.written << " rows, " << csv_stats.abandoned
+                  << " abandoned, drained and synced in " << csv_stats.drain_ms << " ms"
+                  << (csv_stats.reached_end && csv_stats.synced ? "" : " (incomplete)") << std::endl;
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h") {
+            std::cout << usage();
+            return 0;
+        }
+    }
+
+    LoadTestOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    try {
+        std::string port = std::to_string(options.port);
+        if (!options.tls.certificate_chain.empty()) {
+            return run_load_test<websocketpp::config::asio_tls, sparkland::PooledTlsClientConfig>(
+                options, "wss://localhost:" + port);
+        }
+        return run_load_test<websocketpp::config::asio, sparkland::PooledClientConfig>(
+            options, "ws://localhost:" + port);
+    } catch (const std::exception& e) {
+        std::cerr << "Load test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -2,7 +2,16 @@
 #include "sparkland/types.h"
 #include "sparkland/tick_parser.h"
 #include "sparkland/csv_logger.h"
+#include "sparkland/snapshot_cache.h"
 #include "sparkland/logger.h"
+#include "sparkland/config.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/feed_state.h"
+#include "sparkland/thread_placement.h"
+#include "sparkland/huge_pages.h"
+
+#include <cstdio>
+#include <memory>
 
 
 std::atomic<bool> running{true};
@@ -11,39 +20,136 @@ void signal_handler(int) {
     running = false;
 }
 
-int main() {
+// Builds and runs the pipeline for one tick layout (Ring decides Tick or SlimTick) and
+// transport (ClientConfig, wss:// or ws://) until Ctrl+C or a connection failure
+template <typename Ring, typename ClientConfig>
+void run_pipeline(const sparkland::AppConfig& config, const sparkland::ThreadPlacement& io_placement) {
+    using TickSink = sparkland::BasicCSVLogger<typename Ring::Consumer>;
+    using Parser = sparkland::BasicTickParser<Ring>;
+    using Conflation = sparkland::ConflatingBuffer<typename Parser::TickType>;
+    using ConflatedSink = sparkland::BasicCSVLogger<typename Conflation::Reader>;
+    using ShmBus = sparkland::ShmTickBus<typename Parser::TickType>;
+    using Handler = sparkland::ParserHandler<Parser>;
 
-    // Get logger instance
     sparkland::Logger& logger = sparkland::Logger::getInstance();
-    logger.info("Starting the application");
 
-    // Pre-allocated buffer to use
-    sparkland::TickRingBuffer ring_buffer;
+    // Rings are written by the I/O thread, keep them on its NUMA node
+    int numa_node = sparkland::numa_node_of_cpu(io_placement.cpu);
 
-    // Ticker symbols to subscribe
-    std::vector<std::string> products = {
-        "BTC-USD",
-        "ETH-USD", 
-        "SOL-USD",
-    };
+    // Pre-allocated buffer to use, every tick sink gets its own cursor
+    Ring ring_buffer(config.ring_capacity, numa_node);
+    logger.info("Tick ring: " + std::to_string(ring_buffer.storage_bytes()) + " bytes, " +
+                sparkland::to_string(ring_buffer.memory().backing()) + " pages, numa node " +
+                std::to_string(ring_buffer.memory().numa_node()));
+
+    // Completed OHLCV bars from the matches channel
+    sparkland::BarRingBuffer bar_ring(numa_node);
+    bool bars_enabled = false;
+
+    // Latest top-of-book per product for in-process readers
+    sparkland::SnapshotCache snapshot_cache(config.products);
+
+    // Latest tick per product, for consumers that want fresh data over every update
+    std::unique_ptr<Conflation> conflation;
+    std::unique_ptr<typename Conflation::Reader> conflation_reader;
+
+    // Compresses rotated segments, started only if a sink asks for it
+    std::unique_ptr<sparkland::SegmentCompressor> compressor;
+    for (const auto& sink : config.sinks) {
+        if (sink.output.compress && !compressor) compressor = std::make_unique<sparkland::SegmentCompressor>();
+    }
+
+    // Create sinks
+    std::vector<std::unique_ptr<TickSink>> tick_sinks;
+    std::unique_ptr<sparkland::BarCSVLogger> bar_sink;
+    std::unique_ptr<ConflatedSink> conflated_sink;
+    std::unique_ptr<ShmBus> shm_bus;
+    for (const auto& sink : config.sinks) {
+        if (sink.type == "csv") {
+            auto& cursor = ring_buffer.add_consumer(sink.lag_policy);
+            tick_sinks.push_back(std::make_unique<TickSink>(cursor, sink.path, config.wait_strategy,
+                                                            sink.output, compressor.get()));
+            sparkland::ThreadPlacement placement = sink.thread;
+            placement.cpu = sparkland::resolve_cpu(placement.cpu);
+            placement.name = "sl-csv" + std::to_string(tick_sinks.size() - 1);
+            tick_sinks.back()->set_thread_placement(placement);
+        } else if (sink.type == "bars_csv") {
+            bar_sink = std::make_unique<sparkland::BarCSVLogger>(bar_ring, sink.path, config.wait_strategy,
+                                                                  sink.output, compressor.get());
+            sparkland::ThreadPlacement placement = sink.thread;
+            placement.cpu = sparkland::resolve_cpu(placement.cpu);
+            placement.name = "sl-bars";
+            bar_sink->set_thread_placement(placement);
+            bars_enabled = true;
+        } else if (sink.type == "conflated_csv") {
+            conflation = std::make_unique<Conflation>(config.products);
+            conflation_reader = std::make_unique<typename Conflation::Reader>(*conflation);
+            conflated_sink = std::make_unique<ConflatedSink>(*conflation_reader, sink.path, config.wait_strategy,
+                                                             sink.output, compressor.get());
+            sparkland::ThreadPlacement placement = sink.thread;
+            placement.cpu = sparkland::resolve_cpu(placement.cpu);
+            placement.name = "sl-conflated";
+            conflated_sink->set_thread_placement(placement);
+        } else if (sink.type == "shm") {
+            // Written from the parser thread, no sink thread
+            shm_bus = std::make_unique<ShmBus>(sink.path, config.products, config.ring_capacity);
+            logger.info("Shared memory tick bus: " + sink.path);
+        }
+    }
 
     // Create components
-    sparkland::TickParser parser(ring_buffer, products);
-    sparkland::CSVLogger csv_logger(ring_buffer, "ticks.csv");
-    sparkland::CoinbaseClient client("wss://ws-feed.exchange.coinbase.com", products);
+    Parser parser(ring_buffer, config.products, &snapshot_cache,
+                  bars_enabled ? &bar_ring : nullptr, config.ema_period_s);
+    parser.set_conflation(conflation.get());
+    parser.set_shm_bus(shm_bus.get());
+    // Exchange-to-local lag per product and stale feed detection
+    sparkland::FeedLatencyMonitor feed_latency(config.products,
+                                               static_cast<int64_t>(config.stale_feed_s * 1e9),
+                                               static_cast<int64_t>(config.max_feed_lag_ms * 1e6));
+    parser.set_latency_monitor(&feed_latency);
+    std::vector<bool> stale(feed_latency.size(), false);
 
-    client.set_message_handler([&parser, &logger](simdjson::padded_string_view payload){
-        if (!parser.parse_and_push(payload)) {
-            logger.error("Failed to push tick into ring buffer\n");
+    // Warm restart: EMAs, top-of-book and sequences continue from the last snapshot if it is recent
+    std::unique_ptr<sparkland::FeedStateSnapshotter> snapshotter;
+    if (!config.snapshot_path.empty()) {
+        snapshotter = std::make_unique<sparkland::FeedStateSnapshotter>(
+            config.snapshot_path, config.products, config.ema_period_s,
+            static_cast<int64_t>(config.snapshot_interval_s * 1e9));
+        parser.set_snapshotter(snapshotter.get());
+
+        sparkland::FeedState state;
+        std::string error;
+        int64_t now_ns = sparkland::wall_clock_ns();
+        if (sparkland::read_feed_state(config.snapshot_path, config.ema_period_s, now_ns,
+                                       static_cast<int64_t>(config.snapshot_max_age_s * 1e9), state, error)) {
+            size_t restored = parser.restore(state, now_ns);
+            logger.info("Warm restart from " + config.snapshot_path + ": " + std::to_string(restored) +
+                        " products, snapshot " + std::to_string((now_ns - state.written_ns) / 1000000) + " ms old");
+        } else {
+            logger.info("Cold start: " + error);
         }
-    });
+    }
+    // Messages go straight from on_message into the parser, no std::function in between
+    sparkland::BasicCoinbaseClient<Handler, ClientConfig> client(config.uri, config.products, config.channels, Handler{&parser});
+    client.set_thread_placement(io_placement);
 
     // Handle Ctrl+C clean exit
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
+    // Keep the hot memory resident: lock what is mapped now and everything allocated later,
+    // then touch the rings so the first ticks don't take page faults
+    if (config.lock_memory) {
+        sparkland::lock_memory();
+    }
+    sparkland::prefault_memory(ring_buffer.storage(), ring_buffer.storage_bytes());
+    sparkland::prefault_memory(bar_ring.storage(), bar_ring.storage_bytes());
+
     // Start components
-    csv_logger.start();
+    for (auto& sink : tick_sinks) sink->start();
+    if (bar_sink) bar_sink->start();
+    if (conflated_sink) conflated_sink->start();
+    if (snapshotter) snapshotter->start();
     client.start();
 
     std::cout<<"Application Started... (Press Ctrl+C to stop)"<<std::endl;
@@ -64,6 +170,22 @@ int main() {
                 logger.info("Connection established! Market data streaming...");
             }
             last_connection_check = now;
+            // Readers of the bus see a stale heartbeat once the feed is gone
+            if (shm_bus) shm_bus->heartbeat();
+            // Products that stopped ticking or lag behind the exchange, logged once per transition
+            int64_t now_ns = sparkland::wall_clock_ns();
+            for (size_t i = 0; i < feed_latency.size(); ++i) {
+                bool is_stale = feed_latency.stale(i, now_ns);
+                if (is_stale == stale[i]) continue;
+                stale[i] = is_stale;
+                if (is_stale) {
+                    logger.warning("Stale feed: " + feed_latency.product_id(i) + ", last tick " +
+                                   std::to_string((now_ns - feed_latency.last_receive_ns(i)) / 1000000) +
+                                   " ms ago, lag " + std::to_string(feed_latency.last_lag_ns(i) / 1000000) + " ms");
+                } else {
+                    logger.info("Feed recovered: " + feed_latency.product_id(i));
+                }
+            }
         }
         else{
             // Connection lost or never established
@@ -83,9 +205,138 @@ int main() {
     }
 
     logger.info("Initiating shutdown...");
+    auto shutdown_start = std::chrono::steady_clock::now();
     client.stop();
-    // Add some sleep for any in process data
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    csv_logger.stop();
-    logger.info("Shutdown complete.");
+    if (client.handler().failed > 0) {
+        logger.error("Failed to parse or publish " + std::to_string(client.handler().failed) + " messages");
+    }
+    if (snapshotter) {
+        // Parser is stopped, its final state is what the next start continues from
+        snapshotter->stop();
+        logger.info("Feed state snapshots: " + std::to_string(snapshotter->written()) + " written, " +
+                    std::to_string(snapshotter->skipped()) + " skipped, " +
+                    std::to_string(snapshotter->failed()) + " failed");
+    }
+    // I/O thread is joined, the histograms are no longer written
+    for (size_t i = 0; i < feed_latency.size(); ++i) {
+        const auto& lag = feed_latency.lag_histogram(i);
+        const auto& stack = feed_latency.stack_histogram(i);
+        if (lag.count() == 0 && stack.count() == 0) continue;
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "Feed latency %s: lag p50 %.3f p99 %.3f max %.3f ms, stack p50 %.1f p99 %.1f us, "
+                      "%llu clock skewed",
+                      feed_latency.product_id(i).c_str(), lag.percentile(0.50) / 1e6, lag.percentile(0.99) / 1e6,
+                      lag.max() / 1e6, stack.percentile(0.50) / 1e3, stack.percentile(0.99) / 1e3,
+                      static_cast<unsigned long long>(feed_latency.clock_skewed(i)));
+        logger.info(line);
+    }
+    // I/O thread is joined, emit the bars whose interval already elapsed
+    parser.flush_bars(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    // Nothing is published after this, the sinks write up to the marker, fsync and exit
+    parser.end_of_stream();
+
+    // One deadline for all sinks, they drain in parallel on their own threads
+    auto drain_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.drain_timeout_ms);
+    bool complete = true;
+    auto drain = [&](auto& sink) {
+        sparkland::DrainStats stats = sink.stop(drain_deadline);
+        const std::string& path = sink.current_path();  // stable once the writer stopped
+        char line[512];
+        std::snprintf(line, sizeof(line), "Sink %s: %llu rows, %llu abandoned, %llu torn, drained in %.1f ms%s%s",
+                      path.c_str(), static_cast<unsigned long long>(stats.written),
+                      static_cast<unsigned long long>(stats.abandoned),
+                      static_cast<unsigned long long>(stats.torn), stats.drain_ms,
+                      stats.reached_end ? "" : ", deadline passed before end of stream",
+                      stats.synced ? ", synced" : ", NOT synced");
+        if (stats.reached_end && stats.synced) {
+            logger.info(line);
+        } else {
+            logger.error(line);
+            complete = false;
+        }
+    };
+    for (auto& sink : tick_sinks) drain(*sink);
+    if (bar_sink) drain(*bar_sink);
+    if (conflated_sink) {
+        drain(*conflated_sink);
+        logger.info("Conflated updates: " + std::to_string(conflation->conflated()));
+    }
+    if (parser.dropped_bars() > 0) {
+        logger.error("Bars dropped because the bar ring was full: " + std::to_string(parser.dropped_bars()));
+    }
+    const sparkland::ParserStats& parser_stats = parser.stats();
+    if (parser_stats.json_errors + parser_stats.truncated_fields + parser_stats.malformed_numbers +
+        parser_stats.unknown_products > 0) {
+        logger.warning("Parser rejected input, JSON errors: " + std::to_string(parser_stats.json_errors) +
+                       " (last: " + simdjson::error_message(parser_stats.last_error) + ")" +
+                       ", truncated fields: " + std::to_string(parser_stats.truncated_fields) +
+                       ", malformed numbers: " + std::to_string(parser_stats.malformed_numbers) +
+                       ", unknown products: " + std::to_string(parser_stats.unknown_products));
+    }
+    if (compressor) {
+        // Segments closed by the sinks are compressed before exiting, the open ones stay plain
+        compressor->stop();
+        logger.info("Compressed segments: " + std::to_string(compressor->compressed()) +
+                    ", failed: " + std::to_string(compressor->failed()));
+    }
+    double shutdown_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shutdown_start).count();
+    logger.info(std::string(complete ? "Shutdown complete" : "Shutdown incomplete") + " in " +
+                std::to_string(static_cast<int64_t>(shutdown_ms)) + " ms.");
+}
+
+// ws:// feeds (e.g. the local feed simulator) get the plain client
+template <typename Ring>
+void run_for_uri(const sparkland::AppConfig& config, const sparkland::ThreadPlacement& io_placement) {
+    if (sparkland::is_secure_uri(config.uri)) {
+        run_pipeline<Ring, sparkland::PooledTlsClientConfig>(config, io_placement);
+    } else {
+        run_pipeline<Ring, sparkland::PooledClientConfig>(config, io_placement);
+    }
 }
+
+int main(int argc, char* argv[]) {
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--help" || std::string(argv[i]) == "-h") {
+            std::cout << sparkland::ConfigReader::usage();
+            return 0;
+        }
+    }
+
+    // Defaults <- config file <- command line, validated before anything starts
+    sparkland::AppConfig config;
+    try {
+        config = sparkland::ConfigReader::load(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // Get logger instance
+    sparkland::Logger& logger = sparkland::Logger::getInstance();
+    logger.info("Starting the application");
+
+    // Feed lag is measured against the local clock, it is only meaningful when that is synchronized
+    sparkland::ClockSyncStatus clock = sparkland::clock_sync_status();
+    if (clock.synchronized) {
+        logger.info("Clock synchronized, estimated error " + std::to_string(clock.estimated_error_ns / 1000) +
+                    " us, max error " + std::to_string(clock.max_error_ns / 1000) + " us");
+    } else {
+        logger.warning("Clock not synchronized (NTP/PTP), feed lag includes the clock offset");
+    }
+
+    // Resolve "auto" CPUs up front, I/O thread first so it gets the first isolated CPU
+    sparkland::ThreadPlacement io_placement = config.io_thread;
+    io_placement.cpu = sparkland::resolve_cpu(io_placement.cpu);
+    io_placement.name = "sl-io";
+
+    if (config.tick_profile == sparkland::TickProfile::Slim) {
+        logger.info("Tick profile: slim");
+        run_for_uri<sparkland::SlimTickBroadcastRing>(config, io_placement);
+    } else {
+        run_for_uri<sparkland::TickBroadcastRing>(config, io_placement);
+    }
+}
+
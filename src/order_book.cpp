@@ -0,0 +1,137 @@
+#include "sparkland/order_book.h"
+
+#include <algorithm>
+
+namespace sparkland {
+
+namespace {
+
+// Levels closer than this to the touch are found by scanning, deeper ones by binary search
+constexpr size_t LINEAR_SCAN_LEVELS = 16;
+
+// levels is ordered worst -> best according to `better`
+template <typename Better>
+void update_side(std::vector<PriceLevel>& levels, int64_t price, Decimal64 size, Better better) {
+    size_t pos = levels.size();
+    size_t scanned = 0;
+    while (pos > 0 && better(levels[pos - 1].price, price) && scanned < LINEAR_SCAN_LEVELS) {
+        --pos;
+        ++scanned;
+    }
+    if (pos > 0 && better(levels[pos - 1].price, price)) {
+        auto it = std::partition_point(levels.begin(), levels.begin() + pos,
+                                       [&](const PriceLevel& level) { return !better(level.price, price); });
+        pos = static_cast<size_t>(it - levels.begin());
+    }
+
+    // levels[pos - 1] is now the best level not better than price
+    if (pos > 0 && levels[pos - 1].price == price) {
+        if (size.is_zero()) {
+            levels.erase(levels.begin() + (pos - 1));
+        } else {
+            levels[pos - 1].size = size;
+        }
+    } else if (!size.is_zero()) {
+        levels.insert(levels.begin() + pos, PriceLevel{price, size});
+    }
+}
+
+// staged is in feed order, best first: sorted once if it isn't, duplicate prices keep the
+// last size sent, empty levels are dropped, then it is turned around to worst -> best
+template <typename Better>
+void finish_side(std::vector<PriceLevel>& staged, Better better) {
+    auto best_first = [&](const PriceLevel& a, const PriceLevel& b) { return better(a.price, b.price); };
+    if (!std::is_sorted(staged.begin(), staged.end(), best_first)) {
+        std::stable_sort(staged.begin(), staged.end(), best_first);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < staged.size(); ++i) {
+        if (i + 1 < staged.size() && staged[i + 1].price == staged[i].price) continue;
+        if (staged[i].size.is_zero()) continue;
+        staged[kept++] = staged[i];
+    }
+    staged.resize(kept);
+    std::reverse(staged.begin(), staged.end());
+}
+
+}
+
+OrderBook::OrderBook(uint8_t price_scale, size_t reserved_levels)
+    : m_price_scale(price_scale) {
+    m_bids.reserve(reserved_levels);
+    m_asks.reserve(reserved_levels);
+}
+
+void OrderBook::clear() {
+    m_bids.clear();
+    m_asks.clear();
+}
+
+bool OrderBook::apply(Side side, Decimal64 price, Decimal64 size) {
+    Decimal64 tick_price;
+    if (!price.rescale(m_price_scale, tick_price)) return false;
+    int64_t ticks = tick_price.units();
+    if (side == Side::Buy) {
+        update_side(m_bids, ticks, size, [](int64_t a, int64_t b) { return a > b; });
+    } else {
+        update_side(m_asks, ticks, size, [](int64_t a, int64_t b) { return a < b; });
+    }
+    ++m_updates;
+    return true;
+}
+
+void OrderBook::begin_snapshot() {
+    m_staged_bids.clear();
+    m_staged_asks.clear();
+}
+
+bool OrderBook::stage_level(Side side, Decimal64 price, Decimal64 size) {
+    Decimal64 tick_price;
+    if (!price.rescale(m_price_scale, tick_price)) return false;
+    (side == Side::Buy ? m_staged_bids : m_staged_asks).push_back(PriceLevel{tick_price.units(), size});
+    return true;
+}
+
+void OrderBook::commit_snapshot() {
+    finish_side(m_staged_bids, [](int64_t a, int64_t b) { return a > b; });
+    finish_side(m_staged_asks, [](int64_t a, int64_t b) { return a < b; });
+    m_updates += m_staged_bids.size() + m_staged_asks.size();
+
+    // The old sides become the next staging buffers, capacity is kept on both
+    m_bids.swap(m_staged_bids);
+    m_asks.swap(m_staged_asks);
+    begin_snapshot();
+}
+
+Decimal64 OrderBook::mid_price() const {
+    if (!has_top()) return Decimal64();
+    return Decimal64::midpoint(price_of(m_bids.back()), price_of(m_asks.back()));
+}
+
+double OrderBook::weighted_mid(size_t levels) const {
+    if (!has_top() || levels == 0) return 0.0;
+
+    auto side_vwap = [&](const std::vector<PriceLevel>& side, double& quantity) {
+        double notional = 0.0;
+        quantity = 0.0;
+        size_t count = std::min(levels, side.size());
+        for (size_t i = 0; i < count; ++i) {
+            const PriceLevel& level = side[side.size() - 1 - i];
+            double size = level.size.to_double();
+            notional += price_of(level).to_double() * size;
+            quantity += size;
+        }
+        return quantity > 0.0 ? notional / quantity : 0.0;
+    };
+
+    double bid_quantity = 0.0;
+    double ask_quantity = 0.0;
+    double bid_vwap = side_vwap(m_bids, bid_quantity);
+    double ask_vwap = side_vwap(m_asks, ask_quantity);
+
+    // Heavier bid side pulls the fair price towards the ask and vice versa
+    return (bid_vwap * ask_quantity + ask_vwap * bid_quantity) / (bid_quantity + ask_quantity);
+}
+
+}
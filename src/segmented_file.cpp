@@ -0,0 +1,287 @@
+#include "sparkland/segmented_file.h"
+#include "sparkland/logger.h"
+#include "sparkland/thread_placement.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace sparkland {
+
+namespace {
+
+constexpr size_t GZIP_CHUNK = 64 * 1024;
+
+bool exists(const std::string& path) {
+    std::error_code ec;
+    return std::filesystem::exists(path, ec);
+}
+
+// A segment index is taken if the segment exists plain or compressed
+bool segment_taken(const std::string& path) {
+    return exists(path) || exists(path + ".gz");
+}
+
+// fsync through a new descriptor, it flushes whatever any descriptor of the file wrote
+bool fsync_path(const std::string& path, int flags) {
+    int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+}
+
+std::string segment_path(const std::string& base, uint32_t interval_s, std::time_t period_start, uint32_t index) {
+    // Split "dir/ticks.csv" into "dir/ticks" and ".csv", the extension only counts in the file name
+    size_t slash = base.find_last_of('/');
+    size_t dot = base.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash) || dot == slash + 1) {
+        dot = base.size();
+    }
+
+    char index_str[16];
+    std::snprintf(index_str, sizeof(index_str), "%04u", index);
+
+    std::string path = base.substr(0, dot) + ".";
+    if (interval_s > 0) {
+        std::tm utc{};
+        gmtime_r(&period_start, &utc);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &utc);
+        path += stamp;
+        path += ".";
+    }
+    return path + index_str + base.substr(dot);
+}
+
+bool gzip_file(const std::string& path) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return false;
+
+    const std::string tmp = path + ".gz.tmp";
+    gzFile out = gzopen(tmp.c_str(), "wb6");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+
+    std::vector<char> buffer(GZIP_CHUNK);
+    bool ok = true;
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+        if (gzwrite(out, buffer.data(), static_cast<unsigned>(read)) != static_cast<int>(read)) {
+            ok = false;
+            break;
+        }
+    }
+    if (std::ferror(in)) ok = false;
+    std::fclose(in);
+    if (gzclose(out) != Z_OK) ok = false;
+
+    // Only replace the original once the compressed copy is complete
+    if (!ok || std::rename(tmp.c_str(), (path + ".gz").c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    std::remove(path.c_str());
+    return true;
+}
+
+SegmentCompressor::SegmentCompressor() : m_thread(&SegmentCompressor::run, this) {}
+
+SegmentCompressor::~SegmentCompressor() {
+    stop();
+}
+
+void SegmentCompressor::submit(std::string path) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(path));
+    }
+    m_cv.notify_one();
+}
+
+void SegmentCompressor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SegmentCompressor::run() {
+    apply_background_priority("sl-compress");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) return;  // stopping and nothing left
+
+        std::string path = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        if (gzip_file(path)) {
+            m_compressed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            Logger::getInstance().warning("Failed to compress " + path);
+        }
+        lock.lock();
+    }
+}
+
+SegmentedFile::SegmentedFile(const std::string& path, const OutputPolicy& policy, SegmentCompressor* compressor)
+    : m_base(path), m_policy(policy), m_compressor(compressor)
+{
+    if (m_policy.compress && !m_compressor) {
+        throw std::invalid_argument("SegmentedFile: compression needs a SegmentCompressor");
+    }
+
+    if (m_policy.writer == FileWriter::IoUring) {
+        try {
+            m_uring = std::make_unique<UringFileBuf>();
+        } catch (const std::exception& e) {
+            Logger::getInstance().warning(std::string(e.what()) + ", " + path + " uses buffered stream writes");
+        }
+    }
+    if (m_uring) {
+        m_stream.rdbuf(m_uring.get());
+    } else {
+        m_stream.rdbuf(&m_filebuf);
+    }
+
+    if (!m_policy.segmented()) {
+        if (!open(path)) throw std::runtime_error("Failed to open CSV file: " + path);
+        return;
+    }
+
+    // Pick up after the segments earlier runs left for this period
+    std::time_t period = period_of(std::time(nullptr));
+    uint32_t next = 0;
+    while (segment_taken(segment_path(m_base, m_policy.interval_s, period, next))) ++next;
+
+    uint32_t index = next;
+    if (m_policy.open_mode == OpenMode::Append && next > 0 &&
+        exists(segment_path(m_base, m_policy.interval_s, period, next - 1))) {
+        index = next - 1;  // latest segment is still plain, continue it
+    }
+
+    // Earlier segments of the period that were never compressed (e.g. the process was killed)
+    if (m_policy.compress) {
+        for (uint32_t i = 0; i < index; ++i) {
+            std::string earlier = segment_path(m_base, m_policy.interval_s, period, i);
+            if (exists(earlier)) m_compressor->submit(std::move(earlier));
+        }
+    }
+
+    m_period = period;
+    m_index = index;
+    std::string segment = segment_path(m_base, m_policy.interval_s, m_period, m_index);
+    if (!open(segment)) {
+        throw std::runtime_error("Failed to open CSV file: " + segment);
+    }
+}
+
+SegmentedFile::~SegmentedFile() {
+    // The current segment stays plain, the next run continues or compresses it
+    if (m_uring) {
+        m_uring->close();
+    } else {
+        m_filebuf.close();
+    }
+}
+
+bool SegmentedFile::close() {
+    if (m_closed) return true;
+    m_closed = true;
+
+    bool ok;
+    if (m_uring) {
+        uint64_t errors = m_uring->write_errors();
+        m_uring->close();
+        ok = m_uring->write_errors() == errors;
+    } else {
+        ok = m_filebuf.close() != nullptr;
+    }
+
+    std::string dir = std::filesystem::path(m_current).parent_path().string();
+    ok = fsync_path(m_current, O_RDONLY) && ok;
+    ok = fsync_path(dir.empty() ? "." : dir, O_RDONLY | O_DIRECTORY) && ok;
+    return ok;
+}
+
+bool SegmentedFile::rotate_if_due(bool check_size) {
+    std::time_t period = period_of(std::time(nullptr));
+    bool new_period = m_policy.interval_s > 0 && period != m_period;
+
+    bool too_big = check_size && m_policy.max_bytes > 0 && size() >= m_policy.max_bytes;
+    if (!new_period && !too_big) return false;
+
+    uint32_t index = 0;
+    if (new_period) {
+        while (segment_taken(segment_path(m_base, m_policy.interval_s, period, index))) ++index;
+    } else {
+        index = m_index + 1;
+    }
+
+    // The next segment is opened before the current one is closed, if that fails keep writing the current one
+    std::string previous = m_current;
+    std::string segment = segment_path(m_base, m_policy.interval_s, period, index);
+    if (!open(segment)) {
+        Logger::getInstance().error("Failed to open segment " + segment + ", continuing " + previous);
+        return false;
+    }
+
+    // Hand the closed segment to the compressor
+    if (m_policy.compress) {
+        m_compressor->submit(previous);
+    }
+    m_period = period;
+    m_index = index;
+    return true;
+}
+
+bool SegmentedFile::open(const std::string& path) {
+    if (m_uring) {
+        if (!m_uring->open(path, m_policy.direct_io)) return false;
+    } else {
+        std::filebuf next;
+        if (!next.open(path, std::ios::out | std::ios::app)) return false;
+        m_filebuf.close();
+        m_filebuf.swap(next);
+    }
+    m_stream.clear();
+
+    m_current = path;
+    m_needs_header = size() == 0;
+    m_unchecked = 0;
+    ++m_segments;
+    return true;
+}
+
+uint64_t SegmentedFile::size() {
+    if (m_uring) return m_uring->size();
+
+    m_filebuf.pubsync();
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(m_current, ec);
+    return ec ? 0 : size;
+}
+
+std::time_t SegmentedFile::period_of(std::time_t now) const {
+    if (m_policy.interval_s == 0) return 0;
+    return now - now % m_policy.interval_s;
+}
+
+}
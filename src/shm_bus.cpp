@@ -0,0 +1,171 @@
+#include "sparkland/shm_bus.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <new>
+
+namespace sparkland {
+
+namespace {
+
+[[noreturn]] void fail(const std::string& name, const std::string& what) {
+    throw std::runtime_error("Shared memory " + name + ": " + what);
+}
+
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+size_t table_offset(size_t capacity) {
+    return round_up(sizeof(ShmBusHeader), 64) + capacity * sizeof(ShmBusSlot<T>);
+}
+
+}
+
+SharedMemoryRegion SharedMemoryRegion::create(const std::string& name, size_t bytes) {
+    // A fresh object, readers still attached to one from an earlier run keep their old mapping
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) fail(name, std::string("shm_open failed: ") + std::strerror(errno));
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        int error = errno;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        fail(name, std::string("ftruncate failed: ") + std::strerror(error));
+    }
+
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        fail(name, std::string("mmap failed: ") + std::strerror(error));
+    }
+    return SharedMemoryRegion(name, data, bytes, true);
+}
+
+SharedMemoryRegion SharedMemoryRegion::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) fail(name, std::string("shm_open failed: ") + std::strerror(errno));
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        fail(name, "empty or unreadable");
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (data == MAP_FAILED) fail(name, std::string("mmap failed: ") + std::strerror(error));
+    return SharedMemoryRegion(name, data, bytes, false);
+}
+
+SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion&& other) noexcept
+    : m_name(std::move(other.m_name)), m_data(other.m_data), m_size(other.m_size), m_owner(other.m_owner) {
+    other.m_data = nullptr;
+    other.m_owner = false;
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (m_data) munmap(m_data, m_size);
+    if (m_owner) shm_unlink(m_name.c_str());
+}
+
+uint64_t shm_bus_clock_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+template <typename T>
+ShmTickBus<T>::ShmTickBus(const std::string& name, const std::vector<std::string>& product_ids, size_t capacity)
+    : m_region(SharedMemoryRegion::create(name, table_offset<T>(capacity) + product_ids.size() * sizeof(SeqLock<T>))),
+      m_product_ids(product_ids), m_mask(capacity - 1)
+{
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        throw std::invalid_argument("ShmTickBus: capacity must be a power of two");
+    }
+    if (product_ids.size() > SHM_BUS_MAX_PRODUCTS) {
+        throw std::invalid_argument("ShmTickBus: at most 64 products are supported");
+    }
+
+    char* base = static_cast<char*>(m_region.data());
+    m_header = new (base) ShmBusHeader();
+    m_header->schema_version = SHM_BUS_SCHEMA_VERSION;
+    m_header->tick_fields = T::FIELDS;
+    m_header->record_size = static_cast<uint32_t>(sizeof(T));
+    m_header->capacity = static_cast<uint32_t>(capacity);
+    m_header->product_count = static_cast<uint32_t>(product_ids.size());
+    m_header->producer_pid = static_cast<uint32_t>(getpid());
+    m_header->started_ns = shm_bus_clock_ns();
+    m_header->ring_offset = round_up(sizeof(ShmBusHeader), 64);
+    m_header->table_offset = table_offset<T>(capacity);
+    for (size_t i = 0; i < product_ids.size(); ++i) {
+        std::strncpy(m_header->products[i], product_ids[i].c_str(), sizeof(m_header->products[i]) - 1);
+    }
+
+    m_ring = reinterpret_cast<ShmBusSlot<T>*>(base + m_header->ring_offset);
+    for (size_t i = 0; i < capacity; ++i) {
+        // No sequence matches until the slot is written
+        new (&m_ring[i]) ShmBusSlot<T>();
+        m_ring[i].sequence.store(ShmBusSlot<T>::WRITING, std::memory_order_relaxed);
+    }
+    m_table = reinterpret_cast<SeqLock<T>*>(base + m_header->table_offset);
+    for (size_t i = 0; i < product_ids.size(); ++i) {
+        new (&m_table[i]) SeqLock<T>();
+    }
+
+    heartbeat();
+    // Readers accept the bus once the magic is there
+    __atomic_store_n(&m_header->magic, SHM_BUS_MAGIC, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+ShmTickBus<T>::~ShmTickBus() {
+    m_header->closed.store(1, std::memory_order_release);
+}
+
+template <typename T>
+ShmTickBusReader<T>::ShmTickBusReader(const std::string& name)
+    : m_region(SharedMemoryRegion::attach(name))
+{
+    if (m_region.size() < sizeof(ShmBusHeader)) fail(name, "too small for the header");
+    const char* base = static_cast<const char*>(m_region.data());
+    m_header = reinterpret_cast<const ShmBusHeader*>(base);
+
+    if (__atomic_load_n(&m_header->magic, __ATOMIC_ACQUIRE) != SHM_BUS_MAGIC) fail(name, "not initialized");
+    if (m_header->schema_version != SHM_BUS_SCHEMA_VERSION) {
+        fail(name, "schema version " + std::to_string(m_header->schema_version) + ", expected " +
+                   std::to_string(SHM_BUS_SCHEMA_VERSION));
+    }
+    if (m_header->record_size != sizeof(T) || m_header->tick_fields != T::FIELDS) {
+        fail(name, "carries a different tick layout (tick_profile)");
+    }
+    if (m_header->product_count > SHM_BUS_MAX_PRODUCTS ||
+        m_header->table_offset + m_header->product_count * sizeof(SeqLock<T>) > m_region.size()) {
+        fail(name, "truncated");
+    }
+
+    m_capacity = m_header->capacity;
+    m_ring = reinterpret_cast<const ShmBusSlot<T>*>(base + m_header->ring_offset);
+    m_table = reinterpret_cast<const SeqLock<T>*>(base + m_header->table_offset);
+    for (uint32_t i = 0; i < m_header->product_count; ++i) {
+        m_product_ids.emplace_back(m_header->products[i], strnlen(m_header->products[i], sizeof(m_header->products[i])));
+    }
+
+    // Start at the newest tick, like a ring consumer added now
+    m_cursor = m_header->published.load(std::memory_order_acquire);
+}
+
+template class ShmTickBus<Tick>;
+template class ShmTickBus<SlimTick>;
+template class ShmTickBusReader<Tick>;
+template class ShmTickBusReader<SlimTick>;
+
+}
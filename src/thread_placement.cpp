@@ -0,0 +1,182 @@
+#include "sparkland/thread_placement.h"
+#include "sparkland/logger.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+namespace sparkland {
+
+namespace {
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+}
+
+bool pin_current_thread(int cpu) {
+    if (cpu < 0) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+std::vector<int> parse_cpu_list(std::string_view list) {
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string_view::npos) end = list.size();
+        std::string range(list.substr(pos, end - pos));
+        pos = end + 1;
+
+        // Trailing newline from sysfs
+        range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return std::isspace(static_cast<unsigned char>(c)); }),
+                    range.end());
+        if (range.empty()) continue;
+
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::exception&) {
+            // Malformed entry, skip it
+        }
+    }
+    return cpus;
+}
+
+std::vector<int> isolated_cpus() {
+    std::ifstream file("/sys/devices/system/cpu/isolated");
+    std::string list;
+    std::getline(file, list);
+    return parse_cpu_list(list);
+}
+
+int resolve_cpu(int cpu) {
+    if (cpu != AUTO_ISOLATED_CPU) return cpu;
+
+    static std::mutex mutex;
+    static size_t next = 0;
+    static const std::vector<int> isolated = isolated_cpus();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (next >= isolated.size()) return -1;
+    return isolated[next++];
+}
+
+bool apply_thread_placement(const ThreadPlacement& placement) {
+    Logger& logger = Logger::getInstance();
+    bool ok = true;
+
+    if (!placement.name.empty()) {
+        // Linux limits thread names to 15 characters + terminator
+        std::string name = placement.name.substr(0, 15);
+        pthread_setname_np(pthread_self(), name.c_str());
+    }
+    const std::string who = placement.name.empty() ? "thread" : placement.name;
+
+    int cpu = resolve_cpu(placement.cpu);
+    if (placement.cpu == AUTO_ISOLATED_CPU && cpu < 0) {
+        logger.warning(who + ": no isolated CPU left, running unpinned");
+    }
+    if (cpu >= 0) {
+        if (!pin_current_thread(cpu)) {
+            logger.warning(who + ": failed to pin to cpu " + std::to_string(cpu));
+            ok = false;
+        } else {
+            std::vector<int> isolated = isolated_cpus();
+            if (!isolated.empty() && std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()) {
+                logger.warning(who + ": cpu " + std::to_string(cpu) + " is not in the isolated set, expect scheduler noise");
+            }
+            logger.info(who + ": pinned to cpu " + std::to_string(cpu));
+        }
+    }
+
+    if (placement.rt_priority > 0) {
+        sched_param param{};
+        param.sched_priority = placement.rt_priority;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            logger.warning(who + ": SCHED_FIFO priority " + std::to_string(placement.rt_priority) +
+                           " rejected: " + std::strerror(rc));
+            ok = false;
+        } else {
+            logger.info(who + ": SCHED_FIFO priority " + std::to_string(placement.rt_priority));
+        }
+    }
+    return ok;
+}
+
+bool apply_background_priority(const std::string& name) {
+    Logger& logger = Logger::getInstance();
+    bool ok = true;
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    sched_param param{};
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+        logger.warning(name + ": SCHED_IDLE rejected");
+        ok = false;
+    }
+
+    // On Linux the nice value is per thread
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19) != 0) {
+        logger.warning(name + ": failed to set nice 19: " + std::strerror(errno));
+        ok = false;
+    }
+
+    // ioprio_set(IOPRIO_WHO_PROCESS, 0 (calling thread), IOPRIO_CLASS_IDLE), no glibc wrapper
+    constexpr int IOPRIO_WHO_PROCESS = 1;
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0) {
+        logger.warning(name + ": failed to set idle I/O priority: " + std::strerror(errno));
+        ok = false;
+    }
+    return ok;
+}
+
+bool lock_memory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        Logger::getInstance().warning(std::string("mlockall failed: ") + std::strerror(errno));
+        return false;
+    }
+    Logger::getInstance().info("Process memory locked");
+    return true;
+}
+
+void prefault_memory(void* addr, size_t bytes) {
+    if (!addr || bytes == 0) return;
+    // Read-modify-write of the same value faults the page in as writable without changing it
+    auto* p = static_cast<volatile char*>(addr);
+    const size_t step = page_size();
+    for (size_t offset = 0; offset < bytes; offset += step) {
+        p[offset] = p[offset];
+    }
+    p[bytes - 1] = p[bytes - 1];
+}
+
+void prefault_stack(size_t bytes) {
+    // Stack grows down from here, touching a local buffer commits those pages
+    auto* buffer = static_cast<volatile char*>(alloca(bytes));
+    const size_t step = page_size();
+    for (size_t offset = 0; offset < bytes; offset += step) {
+        buffer[offset] = 0;
+    }
+}
+
+}
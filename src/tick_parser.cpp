@@ -1,98 +1,503 @@
 #include "sparkland/tick_parser.h"
+#include <algorithm>
 
 namespace sparkland {
 
-TickParser::TickParser(TickRingBuffer& ringBuffer, const std::vector<std::string>& product_ids)
-    : m_ring_buffer(ringBuffer) {
+template <typename Ring>
+BasicTickParser<Ring>::BasicTickParser(Ring& ringBuffer, const std::vector<std::string>& product_ids,
+                                       SnapshotCache* snapshot_cache, BarRingBuffer* bar_ring,
+                                       double ema_period_s)
+    : m_ring_buffer(ringBuffer), m_snapshot_cache(snapshot_cache), m_bar_ring(bar_ring) {
     
-    for(auto products: product_ids)
-        m_ema_store.emplace(products, EMA(5));
+    for(auto products: product_ids) {
+        m_ema_store.emplace(products, EMA(ema_period_s));
+        if constexpr (TickType::has(tick_fields::WINDOW_STATS)) {
+            m_window_stats.emplace(products, WindowStats());
+        }
+        m_books.emplace(products, ProductBook{OrderBook(), EMA(ema_period_s)});
+        if (m_bar_ring) {
+            auto& aggregators = m_bars[products];
+            for (uint32_t interval_s : DEFAULT_BAR_INTERVALS)
+                aggregators.emplace_back(products, interval_s);
+        }
+    }
 }
 
-auto copy_field = [](auto &doc, const char* field_name, char* dest) {
+// True if the field is there. A missing field is fine, any other error means the document is
+// malformed and simdjson gave up on it, that is thrown like the errors of value()
+auto has_field = [](auto &val) {
+    auto error = val.error();
+    if (error == simdjson::NO_SUCH_FIELD) return false;
+    if (error) throw simdjson::simdjson_error(error);
+    return true;
+};
+
+// Copies a string field into a fixed size char array, cut to fit and always terminated
+// Returns true if the value had to be cut
+auto copy_field = [](auto &doc, const char* field_name, auto& dest) -> bool {
+    static_assert(std::is_array_v<std::remove_reference_t<decltype(dest)>>, "dest must be a char array");
     auto val = doc[field_name];
-    if (!val.error()) {
-        auto str = val.value().get_string().value();
-        std::memcpy(dest, str.data(), str.size());
-        dest[str.size()] = '\0';
-    } else {
+    if (!has_field(val)) {
         dest[0] = '\0'; // field missing → empty string
+        return false;
     }
+    auto str = val.value().get_string().value();
+    size_t size = std::min(str.size(), sizeof(dest) - 1);
+    std::memcpy(dest, str.data(), size);
+    dest[size] = '\0';
+    return size < str.size();
 };
 
-bool TickParser::parse_and_push(simdjson::padded_string_view payload) {
+// Decimal strings are parsed straight from the JSON buffer, no std::string/stod
+// Numbers that don't parse (or don't fit Decimal64) are counted
+auto parse_number = [](std::string_view str, Decimal64& out, ParserStats& stats) {
+    if (Decimal64::parse(str, out)) return true;
+    ++stats.malformed_numbers;
+    return false;
+};
+
+auto parse_decimal = [](auto &doc, const char* field_name, ParserStats& stats) {
+    Decimal64 value;
+    auto val = doc[field_name];
+    if (has_field(val)) {
+        parse_number(val.get_string().value(), value, stats);
+    }
+    return value; // field missing or malformed → 0
+};
+
+// Ticker fields of the latest top-of-book, the level-2 fields are left alone
+auto fill_top_of_book = [](TopOfBook& top, const auto& tick) {
+    top.price = tick.price;
+    top.best_bid = tick.best_bid;
+    top.best_bid_size = tick.best_bid_size;
+    top.best_ask = tick.best_ask;
+    top.best_ask_size = tick.best_ask_size;
+    top.mid_price = tick.mid_price;
+    top.price_ema = tick.price_ema;
+    top.mid_price_ema = tick.mid_price_ema;
+    if constexpr (std::decay_t<decltype(tick)>::has(tick_fields::SEQUENCE)) {
+        top.sequence = tick.sequence;
+    }
+};
+
+auto parse_uint = [](auto &doc, const char* field_name) -> uint64_t {
+    auto val = doc[field_name];
+    if (!has_field(val)) return 0; // field missing
+    return val.get_uint64();
+};
+
+template <typename Ring>
+bool BasicTickParser<Ring>::parse_and_push(simdjson::padded_string_view payload) {
     try {
-        auto doc = m_parser.iterate(payload);
-        
-        // Consider only ticker messages
-        auto type_field = doc["type"];
-
-        // If not able to parse type field return error
-        if (type_field.error()) return false;
-
-        auto type_str = type_field.get_string().value();
-        if (std::strncmp(type_str.data(), "ticker", 6) != 0) return true;
-
-        // Parsing iso time string for EMA
-        // Optimization: Use system time instead of exchange time since parsing iso string is very slow
-        // auto tick_time = parse_iso8601(time_str, time_str.size());
-        auto tick_time = std::chrono::steady_clock::now();
-        
-        // Acquire next free slot
-        Tick* slot = m_ring_buffer.acquire_free_slot();
-        if (!slot) {
-            // Buffer full
-            return false;
+        simdjson::ondemand::document doc = m_parser.iterate(payload);
+        return handle_document(doc);
+    } catch (const simdjson::simdjson_error& e) {
+        count_json_error(e.error());
+        return false;
+    }
+}
+
+template <typename Ring>
+size_t BasicTickParser<Ring>::parse_batch(simdjson::padded_string_view payloads) {
+    size_t failed = 0;
+    m_batching = true;
+    m_batch_pending = 0;
+
+    // One stage 1 pass over the whole batch, then each document in turn. Malformed input ends
+    // the stream (it can't resynchronise past it), the frames from there on are parsed one by one
+    size_t resume = payloads.size();
+    {
+        simdjson::ondemand::document_stream stream;
+        size_t window = std::max(payloads.size(), MIN_BATCH_WINDOW);
+        if (m_parser.iterate_many(payloads.data(), payloads.size(), window).get(stream)) {
+            resume = 0;
+        } else {
+            for (auto it = stream.begin(); it != stream.end(); ++it) {
+                simdjson::ondemand::document_reference doc;
+                if ((*it).get(doc)) {
+                    // Not necessarily this frame's fault (stage 1 covers the whole window),
+                    // it is parsed again on its own and counted there
+                    resume = it.current_index();
+                    break;
+                }
+                uint64_t json_errors = m_stats.json_errors;
+                try {
+                    if (!handle_document(doc)) ++failed;
+                } catch (const simdjson::simdjson_error& e) {
+                    count_json_error(e.error());
+                    ++failed;
+                }
+                // A document that turned out malformed half way is abandoned by simdjson, advancing
+                // the stream past it would dereference its released parser. It is counted already,
+                // parsing goes on with the next frame
+                if (m_stats.json_errors != json_errors) {
+                    const char* frame = payloads.data() + it.current_index();
+                    const char* newline = static_cast<const char*>(
+                        std::memchr(frame, '\n', payloads.size() - it.current_index()));
+                    resume = newline ? static_cast<size_t>(newline - payloads.data()) + 1 : payloads.size();
+                    break;
+                }
+            }
+        }
+    }
+    if (resume < payloads.size()) {
+        failed += parse_frames(payloads, resume);
+    }
+
+    // Consumers see the whole batch at once
+    if (m_batch_pending > 0) {
+        m_ring_buffer.publish_slots(m_batch_pending);
+    }
+    m_batching = false;
+    m_batch_pending = 0;
+    return failed;
+}
+
+template <typename Ring>
+size_t BasicTickParser<Ring>::parse_frames(simdjson::padded_string_view payloads, size_t offset) {
+    size_t failed = 0;
+    const char* data = payloads.data();
+    size_t end = payloads.size();
+    while (offset < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data + offset, '\n', end - offset));
+        size_t frame_end = newline ? static_cast<size_t>(newline - data) : end;
+        std::string_view frame(data + offset, frame_end - offset);
+        if (frame.find_first_not_of(" \t\r") != std::string_view::npos) {
+            // What follows the frame is readable: the rest of the batch, then its padding
+            simdjson::padded_string_view view(frame.data(), frame.size(), payloads.capacity() - offset);
+            try {
+                simdjson::ondemand::document doc = m_parser.iterate(view);
+                if (!handle_document(doc)) ++failed;
+            } catch (const simdjson::simdjson_error& e) {
+                count_json_error(e.error());
+                ++failed;
+            }
         }
+        offset = frame_end + 1;
+    }
+    return failed;
+}
+
+template <typename Ring>
+bool BasicTickParser<Ring>::handle_document(simdjson::ondemand::document_reference doc) {
+    auto type_field = doc["type"];
+
+    // If not able to parse type field return error
+    if (!has_field(type_field)) return false;
 
-        //Parse tick
+    std::string_view type_str = type_field.get_string().value();
+
+    // Level-2 book messages only update the books, nothing is published to the ring
+    if (type_str == "l2update" || type_str == "snapshot") {
+        return apply_book_message(doc, type_str == "snapshot");
+    }
+
+    // Trades only feed the bar aggregators ("last_match" replays an old trade on subscribe)
+    if (type_str == "match") {
+        return apply_match(doc);
+    }
+
+    // Ignore everything else except ticker messages
+    if (type_str != "ticker") return true;
+
+    // The EMAs and windows decay on the local monotonic clock: exchange time is only trusted for
+    // the lag measurement, a missing, skewed or out of order "time" mustn't move them
+    auto tick_time = std::chrono::steady_clock::now();
+    int64_t receive_ns = m_receive_ns > 0 ? m_receive_ns : wall_clock_ns();
+    
+    // Acquire next free slot, past the ticks of the current batch that aren't published yet
+    TickType* slot = m_ring_buffer.acquire_free_slot(m_batch_pending);
+    bool ring_full = slot == nullptr;
+    if (ring_full) {
+        // Buffer full, the tick is lost for the ring but the conflating stage and the bus still get it
+        if (!m_conflation && !m_shm_bus) return false;
+        slot = &m_overflow;
+    }
+
+    // Parse tick, only the fields TickType carries and in feed order so every lookup
+    // continues where the previous one stopped
+    if constexpr (TickType::has(tick_fields::TYPE)) {
         std::memcpy(slot->type, type_str.data(), type_str.size());
         slot->type[type_str.size()] = '\0';
-        
-        copy_field(doc, "product_id", slot->product_id);
-        copy_field(doc, "side", slot->side);
-        copy_field(doc, "time", slot->time);
-        
-        auto seq_res = doc["sequence"];
-        if (!seq_res.error()) {
-            slot->sequence = seq_res.get_uint64();
-        } else {
-            slot->sequence = 0;
+    }
+    if constexpr (TickType::has(tick_fields::SEQUENCE)) {
+        slot->sequence = parse_uint(doc, "sequence");
+    }
+    // Cut ids can't be trusted to name the right product, both are dropped before anything is updated
+    if (copy_field(doc, "product_id", slot->product_id)) {
+        ++m_stats.truncated_fields;
+        return false;
+    }
+    auto product_ema = m_ema_store.find(slot->product_id);
+    if (product_ema == m_ema_store.end()) {
+        ++m_stats.unknown_products;
+        return false;
+    }
+    slot->price = parse_decimal(doc, "price", m_stats);
+    if constexpr (TickType::has(tick_fields::STATS_24H)) {
+        slot->open_24h = parse_decimal(doc, "open_24h", m_stats);
+        slot->volume_24h = parse_decimal(doc, "volume_24h", m_stats);
+        slot->low_24h = parse_decimal(doc, "low_24h", m_stats);
+        slot->high_24h = parse_decimal(doc, "high_24h", m_stats);
+        slot->volume_30d = parse_decimal(doc, "volume_30d", m_stats);
+    }
+    slot->best_bid = parse_decimal(doc, "best_bid", m_stats);
+    slot->best_bid_size = parse_decimal(doc, "best_bid_size", m_stats);
+    slot->best_ask = parse_decimal(doc, "best_ask", m_stats);
+    slot->best_ask_size = parse_decimal(doc, "best_ask_size", m_stats);
+    if constexpr (TickType::has(tick_fields::SIDE)) {
+        m_stats.truncated_fields += copy_field(doc, "side", slot->side);
+    }
+    if constexpr (TickType::has(tick_fields::TIME)) {
+        m_stats.truncated_fields += copy_field(doc, "time", slot->time);
+    }
+    if constexpr (TickType::has(tick_fields::TRADE_ID)) {
+        slot->trade_id = parse_uint(doc, "trade_id");
+    }
+    if constexpr (TickType::has(tick_fields::LAST_SIZE)) {
+        slot->last_size = parse_decimal(doc, "last_size", m_stats);
+    }
+    if constexpr (TickType::has(tick_fields::RECEIVE_TIME)) {
+        slot->receive_time_ns = receive_ns;
+    }
+    slot->mid_price = Decimal64::midpoint(slot->best_bid, slot->best_ask);
+   
+    EMA& ema = product_ema->second;
+    ema.update(slot->price.to_double(), slot->mid_price.to_double(), tick_time);
+    slot->price_ema = ema.price_ema();
+    slot->mid_price_ema = ema.mid_ema();
+
+    if constexpr (TickType::has(tick_fields::WINDOW_STATS)) {
+        static_assert(TickType::has(tick_fields::LAST_SIZE), "window VWAP is weighted by last_size");
+        m_window_stats.at(slot->product_id).update(slot->price.to_double(), slot->last_size.to_double(),
+                                                   slot->best_bid.to_double(), slot->best_ask.to_double(),
+                                                   tick_time, slot->window_stats);
+    }
+
+    // Exchange time against the socket read, ticks without a time only feed the stale detector
+    int latency_index = m_latency ? m_latency->index_of(slot->product_id) : -1;
+    if (latency_index >= 0) {
+        int64_t exchange_ns = -1;
+        if constexpr (TickType::has(tick_fields::TIME)) {
+            exchange_ns = parse_exchange_time(slot->time);
         }
+        m_latency->record(static_cast<size_t>(latency_index), receive_ns, exchange_ns, wall_clock_ns());
+    }
 
-        auto trade_id = doc["trade_id"];
-        if (!trade_id.error()) {
-            slot->trade_id = trade_id.get_uint64();
-        } else {
-            slot->trade_id = 0;
+    // Latest state for in-process readers that don't need every tick
+    int cache_index = m_snapshot_cache ? m_snapshot_cache->index_of(slot->product_id) : -1;
+    if (cache_index >= 0) {
+        fill_top_of_book(m_snapshot_cache->stage(cache_index), *slot);
+        m_snapshot_cache->publish(cache_index);
+    }
+
+    // Warm restart state, copied out and written by the snapshotter's own thread
+    int state_index = m_snapshotter ? m_snapshotter->index_of(slot->product_id) : -1;
+    if (state_index >= 0) {
+        ProductState& state = m_snapshotter->stage(static_cast<size_t>(state_index));
+        fill_top_of_book(state.top, *slot);
+        state.ema_update_ns = receive_ns;
+        m_snapshotter->maybe_snapshot(receive_ns);
+    }
+
+    // Latest tick per product for consumers that only want fresh data
+    if (m_conflation) {
+        int conflation_index = m_conflation->index_of(slot->product_id);
+        if (conflation_index >= 0) {
+            m_conflation->update(static_cast<size_t>(conflation_index), *slot);
         }
+    }
 
-        slot->price = !doc["price"].error() ? std::stod(std::string(doc["price"].get_string().value())) : 0.0;
-        slot->open_24h = !doc["open_24h"].error() ? std::stod(std::string(doc["open_24h"].get_string().value())) : 0.0;
-        slot->volume_24h = !doc["volume_24h"].error() ? std::stod(std::string(doc["volume_24h"].get_string().value())) : 0.0;
-        slot->low_24h = !doc["low_24h"].error() ? std::stod(std::string(doc["low_24h"].get_string().value())) : 0.0;
-        slot->high_24h = !doc["high_24h"].error() ? std::stod(std::string(doc["high_24h"].get_string().value())) : 0.0;
-        slot->volume_30d = !doc["volume_30d"].error() ? std::stod(std::string(doc["volume_30d"].get_string().value())) : 0.0;
-        slot->best_bid = !doc["best_bid"].error() ? std::stod(std::string(doc["best_bid"].get_string().value())) : 0.0;
-        slot->best_bid_size = !doc["best_bid_size"].error() ? std::stod(std::string(doc["best_bid_size"].get_string().value())) : 0.0;
-        slot->best_ask = !doc["best_ask"].error() ? std::stod(std::string(doc["best_ask"].get_string().value())) : 0.0;
-        slot->best_ask_size = !doc["best_ask_size"].error() ? std::stod(std::string(doc["best_ask_size"].get_string().value())) : 0.0;
-        slot->last_size = !doc["last_size"].error() ? std::stod(std::string(doc["last_size"].get_string().value())) : 0.0;
-        slot->mid_price = (slot->best_bid + slot->best_ask) / 2;
-       
-        auto& product_ema = m_ema_store.at(slot->product_id);
-        product_ema.update(slot->price, slot->mid_price, tick_time);
-        slot->price_ema = product_ema.price_ema();
-        slot->mid_price_ema = product_ema.mid_ema();
-
-        // Make it available for logging
+    // Other processes on the host
+    if (m_shm_bus) {
+        m_shm_bus->publish(m_shm_bus->index_of(slot->product_id), *slot);
+    }
+    if (ring_full) return false;
+
+    // Make it available for logging, batches are published together at the end
+    if (m_batching) {
+        ++m_batch_pending;
+    } else {
         m_ring_buffer.publish_slot();
-        return true;
+    }
+    return true;
+}
 
-    } catch (const simdjson::simdjson_error& e) {
-        std::cerr << "JSON parse error: " << e.what() << std::endl;
+template <typename Ring>
+bool BasicTickParser<Ring>::apply_book_message(simdjson::ondemand::document_reference doc, bool is_snapshot) {
+    auto product_field = doc["product_id"];
+    if (!has_field(product_field)) return false;
+
+    std::string_view product_id = product_field.get_string().value();
+    auto it = m_books.find(std::string(product_id));
+    if (it == m_books.end()) return true; // not subscribed
+
+    OrderBook& book = it->second.book;
+    Decimal64 price;
+    Decimal64 size;
+
+    if (is_snapshot) {
+        // {"bids": [["price", "size"], ...], "asks": [...]}, replaces the book only once it parsed whole
+        book.begin_snapshot();
+        for (auto [field, side] : {std::make_pair("bids", Side::Buy), std::make_pair("asks", Side::Sell)}) {
+            for (auto level : doc[field].get_array()) {
+                auto values = level.get_array();
+                auto value = values.begin();
+                if (value == values.end() || !parse_number((*value).get_string().value(), price, m_stats)) return false;
+                ++value;
+                if (value == values.end() || !parse_number((*value).get_string().value(), size, m_stats)) return false;
+                if (!book.stage_level(side, price, size)) {
+                    ++m_stats.malformed_numbers;  // price too large for the book's scale
+                    return false;
+                }
+            }
+        }
+        book.commit_snapshot();
+    } else {
+        // {"changes": [["buy", "price", "size"], ...]}
+        for (auto change : doc["changes"].get_array()) {
+            auto values = change.get_array();
+            auto value = values.begin();
+            if (value == values.end()) return false;
+            Side side = (*value).get_string().value() == "buy" ? Side::Buy : Side::Sell;
+            ++value;
+            if (value == values.end() || !parse_number((*value).get_string().value(), price, m_stats)) return false;
+            ++value;
+            if (value == values.end() || !parse_number((*value).get_string().value(), size, m_stats)) return false;
+            if (!book.apply(side, price, size)) {
+                ++m_stats.malformed_numbers;
+                return false;
+            }
+        }
+    }
+
+    if (!book.has_top()) return true;
+
+    double microprice = book.microprice();
+    double weighted_mid = book.weighted_mid(OrderBook::DEFAULT_WEIGHTED_DEPTH);
+    EMA& book_ema = it->second.ema;
+    book_ema.update(microprice, weighted_mid, std::chrono::steady_clock::now());
+
+    int cache_index = m_snapshot_cache ? m_snapshot_cache->index_of(product_id) : -1;
+    if (cache_index >= 0) {
+        TopOfBook& top = m_snapshot_cache->stage(cache_index);
+        const PriceLevel& bid = book.level(Side::Buy, 0);
+        const PriceLevel& ask = book.level(Side::Sell, 0);
+        top.best_bid = book.price_of(bid);
+        top.best_bid_size = bid.size;
+        top.best_ask = book.price_of(ask);
+        top.best_ask_size = ask.size;
+        top.mid_price = book.mid_price();
+        top.microprice = microprice;
+        top.weighted_mid = weighted_mid;
+        top.microprice_ema = book_ema.price_ema();
+        top.weighted_mid_ema = book_ema.mid_ema();
+        m_snapshot_cache->publish(cache_index);
+    }
+    return true;
+}
+
+template <typename Ring>
+bool BasicTickParser<Ring>::apply_match(simdjson::ondemand::document_reference doc) {
+    Trade trade;
+    if (copy_field(doc, "product_id", trade.product_id)) {
+        ++m_stats.truncated_fields;
         return false;
     }
+    auto it = m_bars.find(trade.product_id);
+    if (it == m_bars.end()) return true; // not subscribed or bars disabled
+
+    m_stats.truncated_fields += copy_field(doc, "side", trade.side);
+    trade.trade_id = doc["trade_id"].get_uint64();
+    trade.sequence = doc["sequence"].get_uint64();
+    if (!parse_number(doc["price"].get_string().value(), trade.price, m_stats)) return false;
+    if (!parse_number(doc["size"].get_string().value(), trade.size, m_stats)) return false;
+
+    int64_t time_ns = parse_exchange_time(doc["time"].get_string().value());
+    if (time_ns < 0) return false;
+    trade.time_us = time_ns / 1000;
+
+    Bar completed;
+    for (auto& aggregator : it->second) {
+        if (aggregator.add(trade, completed)) {
+            publish_bar(completed);
+        }
+    }
+    return true;
+}
+
+template <typename Ring>
+void BasicTickParser<Ring>::count_json_error(simdjson::error_code error) {
+    ++m_stats.json_errors;
+    m_stats.last_error = error;
+}
+
+template <typename Ring>
+void BasicTickParser<Ring>::publish_bar(const Bar& bar) {
+    Bar* slot = m_bar_ring->acquire_free_slot();
+    if (!slot) {
+        ++m_dropped_bars;
+        return;
+    }
+    *slot = bar;
+    m_bar_ring->publish_slot();
+}
+
+template <typename Ring>
+void BasicTickParser<Ring>::flush_bars(int64_t now_us) {
+    Bar completed;
+    for (auto& [product, aggregators] : m_bars) {
+        for (auto& aggregator : aggregators) {
+            if (aggregator.flush(now_us, completed)) {
+                publish_bar(completed);
+            }
+        }
+    }
+}
+
+template <typename Ring>
+size_t BasicTickParser<Ring>::restore(const FeedState& state, int64_t now_ns) {
+    auto steady_now = std::chrono::steady_clock::now();
+    size_t restored = 0;
+    for (const ProductState& product : state.products) {
+        auto ema = m_ema_store.find(product.product_id);
+        if (ema == m_ema_store.end()) continue;
+
+        // The EMA decays over the downtime on the next tick like over any other gap
+        if (product.ema_update_ns > 0) {
+            auto age = std::chrono::nanoseconds(std::max<int64_t>(now_ns - product.ema_update_ns, 0));
+            ema->second.restore(product.top.price_ema, product.top.mid_price_ema,
+                                steady_now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(age));
+        }
+
+        int cache_index = m_snapshot_cache ? m_snapshot_cache->index_of(product.product_id) : -1;
+        if (cache_index >= 0) {
+            m_snapshot_cache->update(static_cast<size_t>(cache_index), product.top);
+        }
+        int state_index = m_snapshotter ? m_snapshotter->index_of(product.product_id) : -1;
+        if (state_index >= 0) {
+            m_snapshotter->stage(static_cast<size_t>(state_index)) = product;
+        }
+        ++restored;
+    }
+    return restored;
+}
+
+template <typename Ring>
+void BasicTickParser<Ring>::end_of_stream() {
+    m_ring_buffer.close();
+    if (m_bar_ring) m_bar_ring->close();
+    if (m_conflation) m_conflation->close();
 }
 
+template <typename Ring>
+const OrderBook* BasicTickParser<Ring>::book(const std::string& product_id) const {
+    auto it = m_books.find(product_id);
+    return it == m_books.end() ? nullptr : &it->second.book;
+}
+
+template class BasicTickParser<TickRingBuffer>;
+template class BasicTickParser<TickBroadcastRing>;
+template class BasicTickParser<SlimTickBroadcastRing>;
+
 } // namespace sparkland
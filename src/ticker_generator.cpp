@@ -0,0 +1,140 @@
+#include "sparkland/ticker_generator.h"
+#include "sparkland/feed_latency.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+namespace sparkland {
+
+namespace {
+
+// Value of a string field ("key": "value" or "key":"value"), npos if missing
+size_t find_string_value(std::string_view message, std::string_view key, size_t& length) {
+    std::string quoted = "\"" + std::string(key) + "\"";
+    size_t pos = message.find(quoted);
+    if (pos == std::string_view::npos) return pos;
+    pos = message.find('"', pos + quoted.size());
+    if (pos == std::string_view::npos) return pos;
+    size_t end = message.find('"', pos + 1);
+    if (end == std::string_view::npos) return end;
+    length = end - pos - 1;
+    return pos + 1;
+}
+
+void append_cents(std::string& out, int64_t cents) {
+    char buffer[32];
+    int len = std::snprintf(buffer, sizeof(buffer), "%" PRId64 ".%02" PRId64, cents / 100, cents % 100);
+    out.append(buffer, static_cast<size_t>(len));
+}
+
+}
+
+TickerGenerator::TickerGenerator(const FeedProfile& profile) : m_random(profile.seed) {
+    m_message.reserve(1024);
+    if (!profile.replay_path.empty()) {
+        load_replay(profile.replay_path);
+        return;
+    }
+
+    // More would need longer ids, which would collide once cut to the tick's product_id field
+    if (profile.product_count > MAX_SYNTHETIC_PRODUCTS) {
+        throw std::invalid_argument("At most " + std::to_string(MAX_SYNTHETIC_PRODUCTS) + " synthetic products");
+    }
+    for (uint32_t i = 0; i < profile.product_count; ++i) {
+        char id[24];
+        std::snprintf(id, sizeof(id), "SIM%03u-USD", i);
+        // Spread the starting prices so products are told apart in the output
+        int64_t price = 1000000 + static_cast<int64_t>(m_random() % 10000000);
+        m_synthetic.push_back({id, price, price, price, price});
+        m_products.push_back(id);
+    }
+}
+
+void TickerGenerator::load_replay(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open replay file " + path);
+
+    std::set<std::string> products;
+    std::string line;
+    while (std::getline(file, line)) {
+        // Only ticker messages, receivers count what they get against what was sent
+        size_t length = 0;
+        size_t type = find_string_value(line, "type", length);
+        if (type == std::string::npos || line.compare(type, length, "ticker") != 0) continue;
+
+        size_t product = find_string_value(line, "product_id", length);
+        if (product != std::string::npos && products.insert(line.substr(product, length)).second) {
+            m_products.push_back(line.substr(product, length));
+        }
+
+        size_t time = find_string_value(line, "time", length);
+        if (time == std::string::npos) {
+            m_recorded.push_back({line, std::string(), false});
+        } else {
+            m_recorded.push_back({line.substr(0, time), line.substr(time + length), true});
+        }
+    }
+    if (m_recorded.empty()) throw std::runtime_error("Replay file " + path + " has no ticker messages");
+}
+
+const std::string& TickerGenerator::next(int64_t now_ns) {
+    if (m_recorded.empty()) {
+        build_synthetic(now_ns);
+    } else {
+        const RecordedMessage& recorded = m_recorded[m_generated % m_recorded.size()];
+        m_message = recorded.prefix;
+        if (recorded.has_time) {
+            m_message += format_exchange_time(now_ns);
+            m_message += recorded.suffix;
+        }
+    }
+    ++m_generated;
+    return m_message;
+}
+
+void TickerGenerator::build_synthetic(int64_t now_ns) {
+    SyntheticProduct& product = m_synthetic[m_generated % m_synthetic.size()];
+
+    // Random walk of a few cents, spread of 1 to 4 cents around the trade
+    uint64_t random = m_random();
+    int64_t step = static_cast<int64_t>(random % 11) - 5;
+    if (product.price_cents + step > 0) product.price_cents += step;
+    if (product.price_cents < product.low_cents) product.low_cents = product.price_cents;
+    if (product.price_cents > product.high_cents) product.high_cents = product.price_cents;
+    int64_t bid = product.price_cents - static_cast<int64_t>((random >> 8) % 2);
+    int64_t ask = bid + 1 + static_cast<int64_t>((random >> 16) % 4);
+    bool buy = (random >> 24) & 1;
+    char numbers[96];
+
+    m_message.clear();
+    m_message += R"({"type":"ticker","sequence":)";
+    m_message += std::to_string(m_generated + 1);
+    m_message += R"(,"product_id":")";
+    m_message += product.id;
+    m_message += R"(","price":")";
+    append_cents(m_message, product.price_cents);
+    m_message += R"(","open_24h":")";
+    append_cents(m_message, product.open_cents);
+    m_message += R"(","volume_24h":"1234.56","low_24h":")";
+    append_cents(m_message, product.low_cents);
+    m_message += R"(","high_24h":")";
+    append_cents(m_message, product.high_cents);
+    m_message += R"(","volume_30d":"45678.9","best_bid":")";
+    append_cents(m_message, bid);
+    std::snprintf(numbers, sizeof(numbers), R"(","best_bid_size":"0.%08)" PRIu64 R"(","best_ask":")",
+                  (random >> 32) % 100000000);
+    m_message += numbers;
+    append_cents(m_message, ask);
+    std::snprintf(numbers, sizeof(numbers), R"(","best_ask_size":"0.%08)" PRIu64 R"(","side":"%s","time":")",
+                  (random >> 20) % 100000000, buy ? "buy" : "sell");
+    m_message += numbers;
+    m_message += format_exchange_time(now_ns);
+    std::snprintf(numbers, sizeof(numbers), R"(","trade_id":%)" PRIu64 R"(,"last_size":"0.%08)" PRIu64 R"("})",
+                  m_generated + 1, (random >> 12) % 100000000);
+    m_message += numbers;
+}
+
+}
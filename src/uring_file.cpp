@@ -0,0 +1,399 @@
+#include "sparkland/uring_file.h"
+#include "sparkland/logger.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace sparkland {
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <typename T>
+T* at(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// IORING_OP_WRITE and IOSQE_ASYNC need kernel 5.6, older io_uring kernels set up the ring and
+// then fail every write in its completion. IORING_REGISTER_PROBE and IORING_FEAT_RW_CUR_POS came
+// with the same release, so a failed probe or a missing feature bit means no usable writes
+bool supports_writes(int ring_fd, unsigned features) {
+    if ((features & IORING_FEAT_RW_CUR_POS) == 0) return false;
+
+    constexpr unsigned MAX_OPS = 256;
+    alignas(io_uring_probe) unsigned char storage[sizeof(io_uring_probe) + MAX_OPS * sizeof(io_uring_probe_op)] = {};
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+    if (io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, MAX_OPS) < 0) return false;
+
+    auto supported = [probe](unsigned op) {
+        return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    return supported(IORING_OP_WRITE) && supported(IORING_OP_WRITE_FIXED);
+}
+
+}
+
+bool UringFileBuf::available() {
+    static const bool supported = []() {
+        io_uring_params params{};
+        int fd = io_uring_setup(1, &params);
+        if (fd < 0) return false;
+        bool writes = supports_writes(fd, params.features);
+        ::close(fd);
+        return writes;
+    }();
+    return supported;
+}
+
+UringFileBuf::UringFileBuf(size_t buffer_count, size_t buffer_size)
+    : m_buffer_size(round_up(buffer_size, DIRECT_IO_ALIGNMENT)),
+      m_memory(buffer_count * round_up(buffer_size, DIRECT_IO_ALIGNMENT))
+{
+    if (buffer_count < 2) {
+        throw std::invalid_argument("UringFileBuf: at least two buffers are needed");
+    }
+    for (size_t i = 0; i < buffer_count; ++i) {
+        m_buffers.push_back(Buffer{static_cast<char*>(m_memory.data()) + i * m_buffer_size});
+    }
+
+    // Each buffer has at most one write in flight, so the queue never fills up
+    if (!setup(static_cast<unsigned>(buffer_count))) {
+        int error = errno;
+        release();
+        throw std::runtime_error(std::string("io_uring setup failed: ") + std::strerror(error));
+    }
+    if (!supports_writes(m_ring_fd, m_features)) {
+        release();
+        throw std::runtime_error("io_uring has no IORING_OP_WRITE / IOSQE_ASYNC (kernel before 5.6)");
+    }
+
+    // Registered buffers are pinned once instead of on every write, optional
+    std::vector<iovec> iovecs;
+    for (const auto& buffer : m_buffers) iovecs.push_back({buffer.data, m_buffer_size});
+    m_registered = io_uring_register(m_ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                     static_cast<unsigned>(iovecs.size())) == 0;
+    if (!m_registered) {
+        Logger::getInstance().warning(std::string("io_uring buffer registration failed, using plain writes: ") +
+                                      std::strerror(errno));
+    }
+}
+
+UringFileBuf::~UringFileBuf() {
+    finish_file();
+    release();
+}
+
+bool UringFileBuf::setup(size_t entries) {
+    io_uring_params params{};
+    m_ring_fd = io_uring_setup(static_cast<unsigned>(entries), &params);
+    if (m_ring_fd < 0) return false;
+    m_features = params.features;
+
+    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+    }
+
+    m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ring == MAP_FAILED) {
+        m_sq_ring = nullptr;
+        return false;
+    }
+    if (single_mmap) {
+        m_cq_ring = m_sq_ring;
+    } else {
+        m_cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         m_ring_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ring == MAP_FAILED) {
+            m_cq_ring = nullptr;
+            return false;
+        }
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    m_sq_tail = at<unsigned>(m_sq_ring, params.sq_off.tail);
+    m_sq_mask = at<unsigned>(m_sq_ring, params.sq_off.ring_mask);
+    m_sq_array = at<unsigned>(m_sq_ring, params.sq_off.array);
+    m_cq_head = at<unsigned>(m_cq_ring, params.cq_off.head);
+    m_cq_tail = at<unsigned>(m_cq_ring, params.cq_off.tail);
+    m_cq_mask = at<unsigned>(m_cq_ring, params.cq_off.ring_mask);
+    m_cqes = at<io_uring_cqe>(m_cq_ring, params.cq_off.cqes);
+    return true;
+}
+
+void UringFileBuf::release() {
+    if (m_sqes) munmap(m_sqes, m_sqes_size);
+    if (m_cq_ring && m_cq_ring != m_sq_ring) munmap(m_cq_ring, m_cq_ring_size);
+    if (m_sq_ring) munmap(m_sq_ring, m_sq_ring_size);
+    if (m_ring_fd >= 0) ::close(m_ring_fd);
+    m_sqes = nullptr;
+    m_cq_ring = m_sq_ring = nullptr;
+    m_ring_fd = -1;
+}
+
+bool UringFileBuf::open(const std::string& path, bool direct_io) {
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    int fd = -1;
+    bool direct = false;
+    if (direct_io) {
+        fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct = fd >= 0;
+        if (fd < 0 && errno == EINVAL) {
+            Logger::getInstance().warning(path + ": filesystem doesn't support O_DIRECT, using buffered I/O");
+        }
+    }
+    if (fd < 0) fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) return false;
+
+    // Opened, the previous file can be finished (before looking at the size, it may be the same file)
+    finish_file();
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    // O_DIRECT appends start at the block holding the end of the file, its partial content is
+    // read back into the first buffer and written again
+    uint64_t start = size;
+    size_t prefix = 0;
+    if (direct) {
+        start = size & ~static_cast<uint64_t>(DIRECT_IO_ALIGNMENT - 1);
+        prefix = static_cast<size_t>(size - start);
+    }
+
+    m_fd = fd;
+    m_direct = direct;
+
+    size_t index = free_buffer();
+    if (prefix > 0) {
+        int reader = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        bool read_back = reader >= 0 &&
+                         pread(reader, m_buffers[index].data, prefix, static_cast<off_t>(start)) == static_cast<ssize_t>(prefix);
+        if (reader >= 0) ::close(reader);
+        if (!read_back) {
+            Logger::getInstance().warning(path + ": failed to read back the last block, appending without O_DIRECT");
+            ::close(m_fd);
+            m_fd = ::open(path.c_str(), flags, 0644);
+            m_direct = false;
+            start = size;
+            prefix = 0;
+            if (m_fd < 0) return false;
+        }
+    }
+    start_buffer(index, start, prefix);
+    return true;
+}
+
+void UringFileBuf::close() {
+    finish_file();
+}
+
+uint64_t UringFileBuf::size() const {
+    if (m_fd < 0) return 0;
+    const Buffer& buffer = m_buffers[m_current];
+    return buffer.offset + static_cast<uint64_t>(pptr() - buffer.data);
+}
+
+UringFileBuf::int_type UringFileBuf::overflow(int_type c) {
+    if (m_fd < 0) return traits_type::eof();
+
+    // Put area is full, hand it to the kernel and continue in the next free buffer
+    uint64_t offset = size();
+    submit_current(false);
+    start_buffer(free_buffer(), offset, 0);
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize UringFileBuf::xsputn(const char* s, std::streamsize n) {
+    if (m_fd < 0) return 0;
+    std::streamsize done = 0;
+    while (done < n) {
+        std::streamsize room = epptr() - pptr();
+        if (room == 0) {
+            overflow(traits_type::eof());
+            continue;
+        }
+        std::streamsize chunk = std::min(room, n - done);
+        std::memcpy(pptr(), s + done, static_cast<size_t>(chunk));
+        pbump(static_cast<int>(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+int UringFileBuf::sync() {
+    if (m_fd < 0 || m_direct || pptr() == m_buffers[m_current].data) return 0;
+    uint64_t offset = size();
+    submit_current(false);
+    start_buffer(free_buffer(), offset, 0);
+    return 0;
+}
+
+void UringFileBuf::start_buffer(size_t index, uint64_t offset, size_t prefix) {
+    m_current = index;
+    Buffer& buffer = m_buffers[index];
+    buffer.offset = offset;
+    buffer.length = 0;
+    buffer.written = 0;
+    setp(buffer.data, buffer.data + m_buffer_size);
+    pbump(static_cast<int>(prefix));
+}
+
+void UringFileBuf::submit_current(bool pad) {
+    Buffer& buffer = m_buffers[m_current];
+    buffer.length = static_cast<size_t>(pptr() - buffer.data);
+    if (buffer.length == 0) return;
+
+    if (pad) {
+        size_t padded = round_up(buffer.length, DIRECT_IO_ALIGNMENT);
+        std::memset(buffer.data + buffer.length, 0, padded - buffer.length);
+        buffer.length = padded;
+    }
+    buffer.written = 0;
+    buffer.in_flight = true;
+    ++m_in_flight;
+    submit(m_current);
+    setp(nullptr, nullptr);
+}
+
+void UringFileBuf::submit(size_t index) {
+    Buffer& buffer = m_buffers[index];
+
+    // Only this thread produces submissions, the kernel advances the head
+    unsigned tail = *m_sq_tail;
+    unsigned slot = tail & *m_sq_mask;
+    io_uring_sqe& sqe = m_sqes[slot];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = m_registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.flags = IOSQE_ASYNC;  // always hand the write to a kernel worker, never run it inline
+    sqe.fd = m_fd;
+    sqe.addr = reinterpret_cast<uint64_t>(buffer.data + buffer.written);
+    sqe.len = static_cast<uint32_t>(buffer.length - buffer.written);
+    sqe.off = buffer.offset + buffer.written;
+    sqe.buf_index = static_cast<uint16_t>(index);
+    sqe.user_data = index;
+    m_sq_array[slot] = slot;
+    __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    if (enter(1, 0, 0) < 0) {
+        // Not submitted, the buffer is lost
+        ++m_write_errors;
+        buffer.in_flight = false;
+        --m_in_flight;
+        Logger::getInstance().error(std::string("io_uring submit failed: ") + std::strerror(errno));
+    }
+}
+
+size_t UringFileBuf::free_buffer() {
+    // Recycle whatever already completed, no syscall
+    reap(false);
+    bool waited = false;
+    while (true) {
+        for (size_t i = 1; i <= m_buffers.size(); ++i) {
+            size_t index = (m_current + i) % m_buffers.size();
+            if (!m_buffers[index].in_flight) return index;
+        }
+
+        // Every buffer is in flight, the disk is behind
+        if (!waited) ++m_buffer_waits;
+        waited = true;
+        reap(true);
+    }
+}
+
+void UringFileBuf::reap(bool wait) {
+    if (wait) enter(0, 1, IORING_ENTER_GETEVENTS);
+
+    unsigned head = *m_cq_head;
+    unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+        size_t index = static_cast<size_t>(cqe.user_data);
+        int res = cqe.res;
+        ++head;
+
+        Buffer& buffer = m_buffers[index];
+        if (res > 0) {
+            buffer.written += static_cast<size_t>(res);
+            if (buffer.written < buffer.length) {
+                submit(index);  // short write, continue where it stopped
+                continue;
+            }
+        } else if (res == -EINTR || res == -EAGAIN) {
+            submit(index);
+            continue;
+        } else {
+            if (m_write_errors++ == 0) {
+                Logger::getInstance().error(std::string("io_uring write failed: ") +
+                                            (res < 0 ? std::strerror(-res) : "no progress"));
+            }
+        }
+        buffer.in_flight = false;
+        --m_in_flight;
+    }
+    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+}
+
+void UringFileBuf::finish_file() {
+    if (m_fd < 0) return;
+
+    // Last partial buffer, padded to a whole block with O_DIRECT
+    uint64_t final_size = size();
+    submit_current(m_direct);
+    while (m_in_flight > 0) reap(true);
+
+    if (m_direct && ftruncate(m_fd, static_cast<off_t>(final_size)) != 0) {
+        Logger::getInstance().error(std::string("ftruncate after O_DIRECT writes failed: ") + std::strerror(errno));
+    }
+    ::close(m_fd);
+    m_fd = -1;
+    m_direct = false;
+    setp(nullptr, nullptr);
+}
+
+int UringFileBuf::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    int rc;
+    do {
+        rc = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit, min_complete, flags, nullptr, 0));
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+}
+
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "sparkland/bar_aggregator.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+
+using namespace sparkland;
+
+namespace {
+
+constexpr int64_t SECOND = 1000000;
+
+Trade make_trade(int64_t time_us, int64_t price_cents, int64_t size_units) {
+    Trade trade{};
+    std::strcpy(trade.product_id, "BTC-USD");
+    trade.price = Decimal64(price_cents, 2);
+    trade.size = Decimal64(size_units, 0);
+    trade.time_us = time_us;
+    return trade;
+}
+
+std::string match_json(const std::string& time, const std::string& price, const std::string& size) {
+    return R"({"type": "match", "trade_id": 10, "sequence": 50, "side": "sell",
+               "size": ")" + size + R"(", "price": ")" + price + R"(",
+               "product_id": "BTC-USD", "time": ")" + time + R"("})";
+}
+
+}
+
+TEST(BarAggregatorTest, BuildsOhlcvWithinBucket) {
+    BarAggregator aggregator("BTC-USD", 1);
+    Bar completed;
+
+    EXPECT_FALSE(aggregator.add(make_trade(100 * SECOND + 10, 10000, 1), completed));
+    EXPECT_FALSE(aggregator.add(make_trade(100 * SECOND + 20, 10200, 3), completed));
+    EXPECT_FALSE(aggregator.add(make_trade(100 * SECOND + 30, 9900, 1), completed));
+    EXPECT_FALSE(aggregator.add(make_trade(100 * SECOND + 40, 10100, 5), completed));
+    EXPECT_TRUE(aggregator.has_open_bar());
+
+    // First trade of the next bucket closes the bar
+    ASSERT_TRUE(aggregator.add(make_trade(101 * SECOND, 10150, 1), completed));
+    EXPECT_STREQ(completed.product_id, "BTC-USD");
+    EXPECT_EQ(completed.interval_s, 1u);
+    EXPECT_EQ(completed.start_us, 100 * SECOND);
+    EXPECT_EQ(completed.open, Decimal64(10000, 2));
+    EXPECT_EQ(completed.high, Decimal64(10200, 2));
+    EXPECT_EQ(completed.low, Decimal64(9900, 2));
+    EXPECT_EQ(completed.close, Decimal64(10100, 2));
+    EXPECT_EQ(completed.volume, Decimal64(10, 0));
+    EXPECT_EQ(completed.trade_count, 4u);
+    // (100*1 + 102*3 + 99*1 + 101*5) / 10
+    EXPECT_DOUBLE_EQ(completed.vwap, 101.0);
+
+    ASSERT_EQ(aggregator.history_size(), 1u);
+    EXPECT_EQ(aggregator.history(0).start_us, 100 * SECOND);
+}
+
+TEST(BarAggregatorTest, SkipsEmptyIntervalsAndFlushes) {
+    BarAggregator aggregator("BTC-USD", 60);
+    Bar completed;
+
+    aggregator.add(make_trade(30 * SECOND, 100, 1), completed);
+    EXPECT_FALSE(aggregator.flush(59 * SECOND, completed));  // interval not over yet
+    ASSERT_TRUE(aggregator.flush(60 * SECOND, completed));
+    EXPECT_EQ(completed.start_us, 0);
+    EXPECT_FALSE(aggregator.has_open_bar());
+
+    // Next trade several minutes later starts a fresh bar, no empty bars in between
+    EXPECT_FALSE(aggregator.add(make_trade(301 * SECOND, 200, 1), completed));
+    ASSERT_TRUE(aggregator.flush(400 * SECOND, completed));
+    EXPECT_EQ(completed.start_us, 300 * SECOND);
+    EXPECT_EQ(aggregator.history_size(), 2u);
+}
+
+TEST(BarAggregatorTest, HistoryRingKeepsMostRecentBars) {
+    BarAggregator aggregator("BTC-USD", 1);
+    Bar completed;
+    size_t total = BarAggregator::HISTORY + 10;
+    for (size_t i = 0; i <= total; ++i) {
+        aggregator.add(make_trade(static_cast<int64_t>(i) * SECOND, 100, 1), completed);
+    }
+
+    EXPECT_EQ(aggregator.history_size(), BarAggregator::HISTORY);
+    EXPECT_EQ(aggregator.history(0).start_us, static_cast<int64_t>(total - 1) * SECOND);
+    EXPECT_EQ(aggregator.history(BarAggregator::HISTORY - 1).start_us,
+              static_cast<int64_t>(total - BarAggregator::HISTORY) * SECOND);
+}
+
+TEST(BarAggregatorTest, TickParserEmitsBarsFromMatches) {
+    std::vector<std::string> products = {"BTC-USD"};
+    TickRingBuffer ring_buffer;
+    BarRingBuffer bar_ring;
+    TickParser parser(ring_buffer, products, nullptr, &bar_ring);
+
+    simdjson::padded_string first(match_json("2025-09-07T08:47:52.100000Z", "111135.56", "0.5"));
+    simdjson::padded_string second(match_json("2025-09-07T08:47:52.900000Z", "111136.00", "1.5"));
+    simdjson::padded_string third(match_json("2025-09-07T08:47:53.000001Z", "111137.00", "1"));
+    ASSERT_TRUE(parser.parse_and_push(first));
+    ASSERT_TRUE(parser.parse_and_push(second));
+    EXPECT_TRUE(bar_ring.empty());
+    ASSERT_TRUE(parser.parse_and_push(third));
+
+    // Trades never reach the tick ring
+    EXPECT_TRUE(ring_buffer.empty());
+
+    // Only the 1 s bar closed
+    ASSERT_EQ(bar_ring.size(), 1u);
+    Bar* bar = bar_ring.acquire_filled_slot();
+    EXPECT_EQ(bar->interval_s, 1u);
+    EXPECT_EQ(bar->open, Decimal64(11113556, 2));
+    EXPECT_EQ(bar->close, Decimal64(111136, 0));
+    EXPECT_EQ(bar->volume, Decimal64(2, 0));
+    EXPECT_EQ(bar->trade_count, 2u);
+    bar_ring.release_slot();
+
+    // Flushing well after the minute closes both open bars
+    parser.flush_bars(bar->start_us + 120 * SECOND);
+    EXPECT_EQ(bar_ring.size(), 2u);
+    EXPECT_EQ(parser.dropped_bars(), 0u);
+}
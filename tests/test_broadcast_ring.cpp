@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "sparkland/broadcast_ring.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <thread>
+#include <vector>
+
+using namespace sparkland;
+
+namespace {
+
+using IntRing = BroadcastRing<uint64_t, 8>;
+
+bool push(IntRing& ring, uint64_t value) {
+    uint64_t* slot = ring.acquire_free_slot();
+    if (!slot) return false;
+    *slot = value;
+    ring.publish_slot();
+    return true;
+}
+
+}
+
+TEST(BroadcastRingTest, EveryConsumerSeesEverySlot) {
+    IntRing ring;
+    auto& first = ring.add_consumer();
+    auto& second = ring.add_consumer();
+
+    EXPECT_TRUE(first.empty());
+    ASSERT_TRUE(push(ring, 1));
+    ASSERT_TRUE(push(ring, 2));
+    EXPECT_EQ(first.size(), 2u);
+    EXPECT_EQ(second.size(), 2u);
+
+    // Both consumers read the same slot in place
+    uint64_t* a = first.acquire_filled_slot();
+    uint64_t* b = second.acquire_filled_slot();
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(*a, 1u);
+
+    EXPECT_TRUE(first.release_slot());
+    EXPECT_EQ(*first.acquire_filled_slot(), 2u);
+    EXPECT_TRUE(first.release_slot());
+    EXPECT_TRUE(first.empty());
+    EXPECT_EQ(second.size(), 2u);
+}
+
+TEST(BroadcastRingTest, ProducerGatesOnSlowestConsumer) {
+    IntRing ring;
+    auto& fast = ring.add_consumer();
+    auto& slow = ring.add_consumer();
+
+    for (uint64_t i = 0; i < ring.capacity(); ++i) {
+        ASSERT_TRUE(push(ring, i));
+        fast.acquire_filled_slot();
+        fast.release_slot();
+    }
+    EXPECT_TRUE(ring.full());
+    EXPECT_FALSE(push(ring, 99));
+
+    // Slow consumer frees one slot
+    slow.acquire_filled_slot();
+    slow.release_slot();
+    EXPECT_FALSE(ring.full());
+    EXPECT_TRUE(push(ring, 8));
+}
+
+TEST(BroadcastRingTest, DropConsumerDoesNotGate) {
+    IntRing ring;
+    auto& gating = ring.add_consumer();
+    auto& laggard = ring.add_consumer(LagPolicy::Drop);
+
+    for (uint64_t i = 0; i < 20; ++i) {
+        ASSERT_TRUE(push(ring, i));
+        gating.acquire_filled_slot();
+        gating.release_slot();
+    }
+
+    // Laggard resumes from the newest value and reports what it missed
+    uint64_t* value = laggard.acquire_filled_slot();
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, 19u);
+    EXPECT_TRUE(laggard.release_slot());
+    EXPECT_EQ(laggard.dropped(), 19u);
+    EXPECT_TRUE(laggard.empty());
+}
+
+TEST(BroadcastRingTest, DropConsumerDetectsOverwriteWhileReading) {
+    IntRing ring;
+    auto& laggard = ring.add_consumer(LagPolicy::Drop);
+
+    ASSERT_TRUE(push(ring, 0));
+    ASSERT_NE(laggard.acquire_filled_slot(), nullptr);
+
+    // Producer wraps around onto the slot being read
+    for (uint64_t i = 1; i <= ring.capacity(); ++i) {
+        ASSERT_TRUE(push(ring, i));
+    }
+    EXPECT_FALSE(laggard.release_slot());
+    EXPECT_EQ(laggard.dropped(), 1u);
+}
+
+TEST(BroadcastRingTest, ConcurrentConsumersReadInOrder) {
+    BroadcastRing<uint64_t, 64> ring;
+    constexpr uint64_t COUNT = 100000;
+    std::vector<BroadcastRing<uint64_t, 64>::Consumer*> consumers = {
+        &ring.add_consumer(), &ring.add_consumer(), &ring.add_consumer()};
+
+    std::vector<uint64_t> sums(consumers.size(), 0);
+    std::vector<bool> ordered(consumers.size(), true);
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < consumers.size(); ++c) {
+        threads.emplace_back([&, c]() {
+            uint64_t expected = 0;
+            while (expected < COUNT) {
+                uint64_t* value = consumers[c]->acquire_filled_slot();
+                if (!value) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (*value != expected) ordered[c] = false;
+                sums[c] += *value;
+                consumers[c]->release_slot();
+                ++expected;
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < COUNT;) {
+        uint64_t* slot = ring.acquire_free_slot();
+        if (!slot) {
+            std::this_thread::yield();
+            continue;
+        }
+        *slot = i++;
+        ring.publish_slot();
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (size_t c = 0; c < consumers.size(); ++c) {
+        EXPECT_TRUE(ordered[c]);
+        EXPECT_EQ(sums[c], COUNT * (COUNT - 1) / 2);
+    }
+}
+
+TEST(BroadcastRingTest, TickParserPublishesToBroadcastRing) {
+    std::vector<std::string> products = {"BTC-USD"};
+    TickBroadcastRing ring;
+    auto& csv = ring.add_consumer();
+    auto& recorder = ring.add_consumer();
+    BroadcastTickParser parser(ring, products);
+
+    simdjson::padded_string payload(std::string(R"({"type": "ticker", "product_id": "BTC-USD", "price": "110000.5"})"));
+    ASSERT_TRUE(parser.parse_and_push(payload));
+
+    Tick* a = csv.acquire_filled_slot();
+    Tick* b = recorder.acquire_filled_slot();
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a, b);
+    EXPECT_STREQ(a->product_id, "BTC-USD");
+    EXPECT_EQ(a->price, Decimal64(1100005, 1));
+}
+
+TEST(BroadcastRingTest, BatchPublishIsAtomicForConsumers) {
+    BroadcastRing<int, 8> ring;
+    auto& consumer = ring.add_consumer();
+
+    for (size_t i = 0; i < 4; ++i) {
+        int* slot = ring.acquire_free_slot(i);
+        ASSERT_NE(slot, nullptr);
+        *slot = static_cast<int>(i);
+    }
+    EXPECT_TRUE(consumer.empty());
+
+    ring.publish_slots(4);
+    EXPECT_EQ(consumer.size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(*consumer.acquire_filled_slot(), i);
+        consumer.release_slot();
+    }
+
+    // Can't reach further ahead than the slowest consumer allows
+    EXPECT_NE(ring.acquire_free_slot(7), nullptr);
+    EXPECT_EQ(ring.acquire_free_slot(8), nullptr);
+}
+
+TEST(BroadcastRingTest, ConsumersDrainUpToEndOfStream) {
+    IntRing ring;
+    auto& first = ring.add_consumer();
+    auto& second = ring.add_consumer(LagPolicy::Drop);
+    ASSERT_TRUE(push(ring, 1));
+    EXPECT_FALSE(first.drained());
+
+    ring.close();
+    EXPECT_FALSE(first.drained());  // slot before the marker not read yet
+    ASSERT_NE(first.acquire_filled_slot(), nullptr);
+    first.release_slot();
+    EXPECT_TRUE(first.drained());
+    EXPECT_FALSE(second.drained());
+    ASSERT_NE(second.acquire_filled_slot(), nullptr);
+    second.release_slot();
+    EXPECT_TRUE(second.drained());
+}
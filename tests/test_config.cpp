@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "sparkland/config.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace sparkland;
+
+class ConfigTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+
+    void write_config(const std::string& json) {
+        std::ofstream file(path, std::ios::trunc);
+        file << json;
+    }
+
+    // argv helper, keeps the strings alive for the call
+    AppConfig load(std::vector<std::string> args) {
+        args.insert(args.begin(), "sparkland_app");
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(arg.data());
+        return ConfigReader::load(static_cast<int>(argv.size()), argv.data());
+    }
+
+    std::string path = "test_config.json";
+};
+
+TEST_F(ConfigTest, DefaultsAreValid) {
+    AppConfig config = load({});
+    EXPECT_EQ(config.products.size(), 3u);
+    EXPECT_EQ(config.ring_capacity, TICK_BUFFER_CAPACITY);
+    EXPECT_DOUBLE_EQ(config.ema_period_s, DEFAULT_EMA_PERIOD_S);
+    EXPECT_EQ(config.wait_strategy, WaitStrategy::Sleep);
+
+    // Same as the original hard-coded setup: ticker only into ticks.csv, nothing else on disk
+    EXPECT_EQ(config.channels, (std::vector<std::string>{"ticker"}));
+    ASSERT_EQ(config.sinks.size(), 1u);
+    EXPECT_EQ(config.sinks[0].path, "ticks.csv");
+    EXPECT_TRUE(config.snapshot_path.empty());
+}
+
+TEST_F(ConfigTest, ReadsFile) {
+    write_config(R"({
+        "uri": "ws://localhost:9000",
+        "products": ["BTC-USD"],
+        "channels": ["ticker"],
+        "ema_period_s": 30,
+        "tick_profile": "slim",
+        "ring_capacity": 65536,
+        "wait_strategy": "spin",
+        "io_thread": {"cpu": 0, "rt_priority": 50},
+        "lock_memory": true,
+        "sinks": [
+            {"type": "csv", "path": "a.csv"},
+            {"type": "csv", "path": "b.csv", "lag_policy": "drop"}
+        ]
+    })");
+
+    AppConfig config = load({"--config", path});
+    EXPECT_EQ(config.uri, "ws://localhost:9000");
+    EXPECT_EQ(config.products, std::vector<std::string>{"BTC-USD"});
+    EXPECT_DOUBLE_EQ(config.ema_period_s, 30.0);
+    EXPECT_EQ(config.tick_profile, TickProfile::Slim);
+    EXPECT_EQ(config.ring_capacity, 65536u);
+    EXPECT_EQ(config.wait_strategy, WaitStrategy::BusySpin);
+    EXPECT_EQ(config.io_thread.cpu, 0);
+    EXPECT_EQ(config.io_thread.rt_priority, 50);
+    EXPECT_TRUE(config.lock_memory);
+    ASSERT_EQ(config.sinks.size(), 2u);
+    EXPECT_EQ(config.sinks[1].path, "b.csv");
+    EXPECT_EQ(config.sinks[1].lag_policy, LagPolicy::Drop);
+}
+
+TEST_F(ConfigTest, CommandLineOverridesFile) {
+    write_config(R"({"products": ["BTC-USD"], "ring_capacity": 4096})");
+
+    AppConfig config = load({"--config", path, "--products", "ETH-USD,SOL-USD",
+                             "--ring-capacity", "8192", "--csv", "out.csv", "--wait", "yield"});
+    EXPECT_EQ(config.products, (std::vector<std::string>{"ETH-USD", "SOL-USD"}));
+    EXPECT_EQ(config.ring_capacity, 8192u);
+    EXPECT_EQ(config.sinks[0].path, "out.csv");
+    EXPECT_EQ(config.wait_strategy, WaitStrategy::Yield);
+
+    config = load({"--io-cpu", "auto", "--io-priority", "10"});
+    EXPECT_EQ(config.io_thread.cpu, AUTO_ISOLATED_CPU);
+    EXPECT_EQ(config.io_thread.rt_priority, 10);
+
+    // Output options apply to every sink, whatever the option order
+    config = load({"--rotate-mb", "64", "--compress", "--bars", "b.csv", "--channels", "ticker,matches",
+                   "--open-mode", "new_segment"});
+    ASSERT_EQ(config.sinks.size(), 2u);
+    for (const auto& sink : config.sinks) {
+        EXPECT_EQ(sink.output.max_bytes, 64u * 1024 * 1024);
+        EXPECT_TRUE(sink.output.compress);
+        EXPECT_EQ(sink.output.open_mode, OpenMode::NewSegment);
+    }
+
+    config = load({"--writer", "io_uring", "--direct-io"});
+    EXPECT_EQ(config.sinks[0].output.writer, FileWriter::IoUring);
+    EXPECT_TRUE(config.sinks[0].output.direct_io);
+
+    config = load({"--conflated", "latest.csv"});
+    ASSERT_EQ(config.sinks.back().type, "conflated_csv");
+    EXPECT_EQ(config.sinks.back().path, "latest.csv");
+
+    config = load({"--stale-after", "2.5", "--max-lag", "500", "--drain-timeout", "250"});
+    EXPECT_DOUBLE_EQ(config.stale_feed_s, 2.5);
+    EXPECT_DOUBLE_EQ(config.max_feed_lag_ms, 500.0);
+    EXPECT_EQ(config.drain_timeout_ms, 250);
+
+    config = load({"--snapshot", "state.bin", "--snapshot-interval", "0.5", "--snapshot-max-age", "300"});
+    EXPECT_EQ(config.snapshot_path, "state.bin");
+    EXPECT_DOUBLE_EQ(config.snapshot_interval_s, 0.5);
+    EXPECT_DOUBLE_EQ(config.snapshot_max_age_s, 300.0);
+    EXPECT_TRUE(load({"--no-snapshot"}).snapshot_path.empty());
+}
+
+TEST_F(ConfigTest, RejectsInvalidValues) {
+    EXPECT_THROW(load({"--ring-capacity", "1000"}), std::invalid_argument);
+    EXPECT_THROW(load({"--ring-capacity", "0"}), std::invalid_argument);
+    EXPECT_THROW(load({"--ring-capacity", "-9223372036854775808"}), std::invalid_argument);
+    EXPECT_THROW(load({"--ring-capacity", "1073741824"}), std::invalid_argument);
+    EXPECT_THROW(load({"--products", ""}), std::invalid_argument);
+    EXPECT_THROW(load({"--products", "BTC-USD,BTC-USD"}), std::invalid_argument);
+    EXPECT_THROW(load({"--products", "A-VERY-LONG-PRODUCT-ID"}), std::invalid_argument);
+    EXPECT_THROW(load({"--channels", "ticker,full"}), std::invalid_argument);
+    EXPECT_THROW(load({"--ema-period", "0"}), std::invalid_argument);
+    EXPECT_THROW(load({"--ema-period", "5abc"}), std::invalid_argument);
+    EXPECT_THROW(load({"--stale-after", "0"}), std::invalid_argument);
+    EXPECT_THROW(load({"--max-lag", "-1"}), std::invalid_argument);
+    EXPECT_THROW(load({"--max-lag", "1s"}), std::invalid_argument);
+    EXPECT_THROW(load({"--drain-timeout", "-1"}), std::invalid_argument);
+    EXPECT_THROW(load({"--snapshot-interval", "0"}), std::invalid_argument);
+    EXPECT_THROW(load({"--uri", "http://example.com"}), std::invalid_argument);
+    EXPECT_THROW(load({"--io-cpu", "100000"}), std::invalid_argument);
+    EXPECT_THROW(load({"--io-cpu", "any"}), std::invalid_argument);
+    EXPECT_THROW(load({"--io-priority", "100"}), std::invalid_argument);
+    EXPECT_THROW(load({"--wait", "nap"}), std::invalid_argument);
+    EXPECT_THROW(load({"--tick-profile", "tiny"}), std::invalid_argument);
+    EXPECT_THROW(load({"--open-mode", "truncate"}), std::invalid_argument);
+    EXPECT_THROW(load({"--rotate-mb", "-1"}), std::invalid_argument);
+    EXPECT_THROW(load({"--compress"}), std::invalid_argument);  // nothing is ever closed
+    EXPECT_THROW(load({"--writer", "mmap"}), std::invalid_argument);
+    EXPECT_THROW(load({"--direct-io"}), std::invalid_argument);
+    EXPECT_THROW(load({"--unknown"}), std::invalid_argument);
+    EXPECT_THROW(load({"--uri"}), std::invalid_argument);
+
+    // Bars need trades and trades need a bars sink
+    EXPECT_THROW(load({"--bars", "b.csv"}), std::invalid_argument);
+    EXPECT_THROW(load({"--channels", "ticker,matches"}), std::invalid_argument);
+}
+
+TEST_F(ConfigTest, RejectsInvalidFile) {
+    EXPECT_THROW(load({"--config", "does_not_exist.json"}), std::invalid_argument);
+
+    write_config(R"({"products": ["BTC-USD"], "typo_key": 1})");
+    EXPECT_THROW(load({"--config", path}), std::invalid_argument);
+
+    write_config(R"({"ring_capacity": "big"})");
+    EXPECT_THROW(load({"--config", path}), std::invalid_argument);
+
+    write_config(R"({"ring_capacity": -9223372036854775808})");
+    EXPECT_THROW(load({"--config", path}), std::invalid_argument);
+
+    write_config(R"({"sinks": [{"type": "parquet", "path": "x"}]})");
+    EXPECT_THROW(load({"--config", path}), std::invalid_argument);
+
+    write_config(R"({"sinks": [{"type": "conflated_csv", "path": "a"}, {"type": "conflated_csv", "path": "b"}]})");
+    EXPECT_THROW(load({"--config", path}), std::invalid_argument);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "sparkland/conflating_buffer.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace sparkland;
+
+struct Quote {
+    uint64_t product;
+    uint64_t sequence;
+};
+
+TEST(ConflatingBufferTest, KeepsLatestValuePerProduct) {
+    ConflatingBuffer<Quote> buffer({"BTC-USD", "ETH-USD", "SOL-USD"});
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.update(2, {2, 1});
+    buffer.update(0, {0, 1});
+    buffer.update(2, {2, 2});
+    buffer.update(2, {2, 3});
+    EXPECT_FALSE(buffer.empty());
+
+    std::vector<size_t> order;
+    size_t drained = buffer.drain([&](size_t index, const Quote& quote, uint64_t conflated) {
+        order.push_back(index);
+        if (index == 2) {
+            EXPECT_EQ(quote.sequence, 3u);
+            EXPECT_EQ(conflated, 2u);
+        } else {
+            EXPECT_EQ(quote.sequence, 1u);
+            EXPECT_EQ(conflated, 0u);
+        }
+    });
+
+    // Dirty products come out in index order, each once
+    EXPECT_EQ(drained, 2u);
+    EXPECT_EQ(order, (std::vector<size_t>{0, 2}));
+    EXPECT_EQ(buffer.conflated(), 2u);
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.drain([](size_t, const Quote&, uint64_t) {}), 0u);
+}
+
+TEST(ConflatingBufferTest, ReaderMatchesRingInterface) {
+    ConflatingBuffer<Quote> buffer({"BTC-USD", "ETH-USD"});
+    ConflatingBuffer<Quote>::Reader reader(buffer);
+    EXPECT_TRUE(reader.empty());
+    EXPECT_EQ(reader.acquire_filled_slot(), nullptr);
+
+    buffer.update(1, {1, 7});
+    buffer.update(0, {0, 4});
+    Quote* first = reader.acquire_filled_slot();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->product, 0u);
+    reader.release_slot();
+    EXPECT_FALSE(reader.empty());
+    Quote* second = reader.acquire_filled_slot();
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(second->sequence, 7u);
+    reader.release_slot();
+    EXPECT_TRUE(reader.empty());
+
+    // End of stream once the producer closed and the last update was read
+    buffer.update(1, {1, 8});
+    buffer.close();
+    EXPECT_EQ(reader.size(), 1u);
+    EXPECT_FALSE(reader.drained());
+    ASSERT_NE(reader.acquire_filled_slot(), nullptr);
+    reader.release_slot();
+    EXPECT_TRUE(reader.drained());
+}
+
+TEST(ConflatingBufferTest, UpdateDuringReadIsDeliveredOnce) {
+    ConflatingBuffer<Quote> buffer({"BTC-USD", "ETH-USD"});
+    ConflatingBuffer<Quote>::Reader reader(buffer);
+
+    buffer.update(0, {0, 1});
+    buffer.update(1, {1, 1});
+    ASSERT_NE(reader.acquire_filled_slot(), nullptr);  // takes both bits, reads product 0
+    reader.release_slot();
+
+    // Product 1 changes after its bit was taken: read once with the new value, then the
+    // bit the update set again is skipped
+    buffer.update(1, {1, 2});
+    Quote* quote = reader.acquire_filled_slot();
+    ASSERT_NE(quote, nullptr);
+    EXPECT_EQ(quote->sequence, 2u);
+    reader.release_slot();
+    EXPECT_EQ(reader.acquire_filled_slot(), nullptr);
+    EXPECT_TRUE(reader.empty());
+    EXPECT_EQ(buffer.conflated(), 1u);
+}
+
+TEST(ConflatingBufferTest, ConcurrentConsumerSeesMonotonicLatest) {
+    ConflatingBuffer<Quote> buffer({"A", "B", "C", "D"});
+    constexpr uint64_t UPDATES = 200000;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint64_t seq = 1; seq <= UPDATES; ++seq) {
+            buffer.update(seq % 4, {seq % 4, seq});
+        }
+        done = true;
+    });
+
+    uint64_t last[4] = {0, 0, 0, 0};
+    uint64_t reads = 0;
+    bool monotonic = true;
+    auto consume = [&](size_t index, const Quote& quote, uint64_t) {
+        // Strictly increasing: a value is never delivered twice
+        if (quote.product != index || quote.sequence <= last[index]) monotonic = false;
+        last[index] = quote.sequence;
+        ++reads;
+    };
+    while (!done) {
+        if (buffer.drain(consume) == 0) std::this_thread::yield();
+    }
+    producer.join();
+    buffer.drain(consume);
+
+    EXPECT_TRUE(monotonic);
+    // The final value of every product is always delivered
+    for (uint64_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(last[i], UPDATES - (UPDATES - i) % 4);
+    }
+    // Every update is either read once or counted as conflated
+    EXPECT_EQ(reads + buffer.conflated(), UPDATES);
+}
+
+TEST(ConflatingBufferTest, ParserFeedsConflationWhenRingIsFull) {
+    std::vector<std::string> products = {"BTC-USD"};
+    TickRingBuffer ring;
+    ConflatingBuffer<Tick> conflation(products);
+    TickParser parser(ring, products);
+    parser.set_conflation(&conflation);
+
+    auto ticker = [](int price) {
+        return simdjson::padded_string(std::string(R"({"type": "ticker", "product_id": "BTC-USD", "price": ")") +
+                                       std::to_string(price) + R"(", "best_bid": "1", "best_ask": "2"})");
+    };
+
+    // Fill the ring, then keep going: the ring rejects the ticks, conflation keeps the newest
+    for (size_t i = 0; i < ring.capacity(); ++i) {
+        EXPECT_TRUE(parser.parse_and_push(ticker(100)));
+    }
+    EXPECT_FALSE(parser.parse_and_push(ticker(200)));
+    EXPECT_FALSE(parser.parse_and_push(ticker(300)));
+
+    Tick latest{};
+    conflation.drain([&](size_t, const Tick& tick, uint64_t) { latest = tick; });
+    EXPECT_EQ(latest.price, Decimal64(300, 0));
+    EXPECT_EQ(conflation.conflated(), ring.capacity() + 1);
+}
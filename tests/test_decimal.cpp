@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "sparkland/decimal.h"
+#include <sstream>
+#include <string>
+
+using namespace sparkland;
+
+namespace {
+
+std::string format(Decimal64 value) {
+    char buf[Decimal64::MAX_CHARS];
+    return std::string(buf, value.format(buf));
+}
+
+Decimal64 parse(std::string_view str) {
+    Decimal64 value;
+    EXPECT_TRUE(Decimal64::parse(str, value)) << str;
+    return value;
+}
+
+}
+
+TEST(DecimalTest, ParseKeepsWireScale) {
+    Decimal64 price = parse("111135.56");
+    EXPECT_EQ(price.units(), 11113556);
+    EXPECT_EQ(price.scale(), 2);
+
+    Decimal64 size = parse("0.00222536");
+    EXPECT_EQ(size.units(), 222536);
+    EXPECT_EQ(size.scale(), 8);
+
+    Decimal64 integer = parse("109993");
+    EXPECT_EQ(integer.units(), 109993);
+    EXPECT_EQ(integer.scale(), 0);
+
+    Decimal64 negative = parse("-12.5");
+    EXPECT_EQ(negative.units(), -125);
+    EXPECT_EQ(negative.scale(), 1);
+}
+
+TEST(DecimalTest, ParseLongDigitRuns) {
+    // Exercises the 8-digit SWAR path on both sides of the point
+    Decimal64 value = parse("1158609.10516081");
+    EXPECT_EQ(value.units(), 115860910516081);
+    EXPECT_EQ(value.scale(), 8);
+
+    Decimal64 wide = parse("123456789.123456789");
+    EXPECT_EQ(wide.units(), 123456789123456789);
+    EXPECT_EQ(wide.scale(), 9);
+
+    Decimal64 leading_zeros = parse("0000000000000001.5");
+    EXPECT_EQ(leading_zeros.units(), 15);
+}
+
+TEST(DecimalTest, ParseRejectsMalformedInput) {
+    Decimal64 value(7, 0);
+    EXPECT_FALSE(Decimal64::parse("", value));
+    EXPECT_FALSE(Decimal64::parse("-", value));
+    EXPECT_FALSE(Decimal64::parse("1.", value));
+    EXPECT_FALSE(Decimal64::parse("12a4", value));
+    EXPECT_FALSE(Decimal64::parse("1e5", value));
+    EXPECT_FALSE(Decimal64::parse("NaN", value));
+    EXPECT_FALSE(Decimal64::parse("1234567890123456789", value));  // 19 significant digits
+    EXPECT_FALSE(Decimal64::parse("0.1234567890123456789", value)); // scale > 18
+
+    // Output untouched on failure
+    EXPECT_EQ(value.units(), 7);
+}
+
+TEST(DecimalTest, FormatRoundTripsExactly) {
+    for (const char* str : {"111135.56", "4305.0", "0.00222536", "109993", "0",
+                            "-0.5", "1158609.10516081", "100.00", "999999999999999999"}) {
+        EXPECT_EQ(format(parse(str)), str);
+    }
+}
+
+TEST(DecimalTest, StreamOutput) {
+    std::ostringstream oss;
+    oss << parse("111135.56") << "," << Decimal64();
+    EXPECT_EQ(oss.str(), "111135.56,0");
+}
+
+TEST(DecimalTest, ToDoubleMatchesLiteral) {
+    EXPECT_DOUBLE_EQ(parse("111135.56").to_double(), 111135.56);
+    EXPECT_DOUBLE_EQ(parse("0.0450549").to_double(), 0.0450549);
+    EXPECT_DOUBLE_EQ(parse("-3.25").to_double(), -3.25);
+}
+
+TEST(DecimalTest, ComparisonAcrossScales) {
+    EXPECT_EQ(parse("4305.0"), parse("4305"));
+    EXPECT_EQ(parse("4305.10"), parse("4305.1"));
+    EXPECT_LT(parse("4304.98"), parse("4305.1"));
+    EXPECT_GT(parse("0.01"), parse("0.009"));
+    EXPECT_NE(parse("1.01"), parse("1.1"));
+}
+
+TEST(DecimalTest, Rescale) {
+    Decimal64 price = parse("4305.1");
+    EXPECT_EQ(price.rescaled(2).units(), 430510);
+    EXPECT_EQ(price.rescaled(0).units(), 4305);
+    EXPECT_EQ(price.rescaled(2), price);
+}
+
+TEST(DecimalTest, AdditionAcrossScales) {
+    EXPECT_EQ(format(parse("0.0450549") + parse("9.08999")), "9.1350449");
+    EXPECT_EQ(format(parse("1.5") + parse("-2")), "-0.5");
+    EXPECT_EQ(format(Decimal64() + parse("0.00222536")), "0.00222536");
+}
+
+TEST(DecimalTest, MidpointIsExact) {
+    EXPECT_EQ(format(Decimal64::midpoint(parse("4304.98"), parse("4305.1"))), "4305.04");
+    EXPECT_EQ(format(Decimal64::midpoint(parse("110000.0"), parse("110000.5"))), "110000.25");
+    EXPECT_EQ(format(Decimal64::midpoint(parse("111135.55"), parse("111135.57"))), "111135.56");
+}
+
+TEST(DecimalTest, WideValuesDontOverflow) {
+    // 99999999999 at scale 8 is past int64, compared and summed in 128 bits
+    Decimal64 big = parse("99999999999");
+    Decimal64 tiny = parse("0.00000001");
+    EXPECT_GT(big, tiny);
+    EXPECT_LT(tiny, big);
+    EXPECT_LT(parse("-99999999999"), tiny);
+    EXPECT_NE(big, parse("99999999999.0000001"));
+
+    // Finest digits dropped until the result fits
+    EXPECT_EQ(format(Decimal64::midpoint(big, tiny)), "49999999999.50000000");
+    EXPECT_EQ(format(big + tiny), "99999999999.0000000");
+
+    Decimal64 out(7, 1);
+    EXPECT_FALSE(big.rescale(8, out));
+    EXPECT_EQ(out, Decimal64(7, 1));  // untouched
+    EXPECT_TRUE(big.rescale(7, out));
+    EXPECT_EQ(out.units(), 999999999990000000);
+    EXPECT_EQ(big.rescaled(8).units(), std::numeric_limits<int64_t>::max());
+}
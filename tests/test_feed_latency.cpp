@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "sparkland/feed_latency.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <string>
+
+using namespace sparkland;
+
+namespace {
+
+constexpr int64_t MS_NS = 1000000;
+constexpr int64_t SECOND_NS = 1000 * MS_NS;
+
+// 2025-09-07T08:47:52.369411Z
+constexpr int64_t EXCHANGE_NS = 1757234872 * SECOND_NS + 369411000;
+
+}
+
+TEST(ExchangeTimeTest, FormatAndParseRoundTrip) {
+    EXPECT_EQ(format_exchange_time(EXCHANGE_NS), "2025-09-07T08:47:52.369411Z");
+    EXPECT_EQ(format_exchange_time(EXCHANGE_NS + 123, 9), "2025-09-07T08:47:52.369411123Z");
+    EXPECT_EQ(format_exchange_time(EXCHANGE_NS, 0), "2025-09-07T08:47:52Z");
+
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52.369411Z"), EXCHANGE_NS);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52.369411123Z"), EXCHANGE_NS + 123);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52.3694Z"), EXCHANGE_NS - 11000);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52Z"), 1757234872 * SECOND_NS);
+    EXPECT_EQ(parse_exchange_time("1970-01-01T00:00:00Z"), 0);
+    EXPECT_EQ(parse_exchange_time("2024-02-29T23:59:59Z"), 1709251199 * SECOND_NS);
+}
+
+TEST(ExchangeTimeTest, MalformedTimeIsRejected) {
+    EXPECT_EQ(parse_exchange_time(""), -1);
+    EXPECT_EQ(parse_exchange_time("2025-09-07"), -1);
+    EXPECT_EQ(parse_exchange_time("2025-09-07 08:47:52.369411Z"), -1);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52.369411"), -1);
+    EXPECT_EQ(parse_exchange_time("2025-13-07T08:47:52Z"), -1);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:4x:52Z"), -1);
+    EXPECT_EQ(parse_exchange_time("2025-09-07T08:47:52,369Z"), -1);
+    EXPECT_EQ(parse_exchange_time("0000-01-01T00:00:00Z"), -1);
+    EXPECT_EQ(parse_exchange_time("9999-12-31T23:59:59Z"), -1);
+}
+
+TEST(FeedLatencyMonitorTest, RecordsLagAndStack) {
+    FeedLatencyMonitor monitor({"BTC-USD", "ETH-USD"}, 5 * SECOND_NS, 2000 * MS_NS);
+    ASSERT_EQ(monitor.size(), 2u);
+    EXPECT_EQ(monitor.index_of("ETH-USD"), 1);
+    EXPECT_EQ(monitor.index_of("SOL-USD"), -1);
+
+    int64_t receive_ns = EXCHANGE_NS + 40 * MS_NS;
+    monitor.record(0, receive_ns, EXCHANGE_NS, receive_ns + 20000);
+    EXPECT_EQ(monitor.last_lag_ns(0), 40 * MS_NS);
+    EXPECT_EQ(monitor.last_receive_ns(0), receive_ns);
+    EXPECT_EQ(monitor.lag_histogram(0).count(), 1u);
+    EXPECT_EQ(monitor.lag_histogram(0).max(), static_cast<uint64_t>(40 * MS_NS));
+    EXPECT_EQ(monitor.stack_histogram(0).max(), 20000u);
+    EXPECT_EQ(monitor.lag_histogram(1).count(), 0u);
+
+    // No exchange time: stack and receive time only
+    monitor.record(0, receive_ns + MS_NS, -1, receive_ns + MS_NS + 5000);
+    EXPECT_EQ(monitor.lag_histogram(0).count(), 1u);
+    EXPECT_EQ(monitor.stack_histogram(0).count(), 2u);
+    EXPECT_EQ(monitor.last_receive_ns(0), receive_ns + MS_NS);
+}
+
+TEST(FeedLatencyMonitorTest, ExchangeTimeAheadCountsAsClockSkew) {
+    FeedLatencyMonitor monitor({"BTC-USD"}, 5 * SECOND_NS, 2000 * MS_NS);
+    monitor.record(0, EXCHANGE_NS - 3 * MS_NS, EXCHANGE_NS, EXCHANGE_NS);
+    EXPECT_EQ(monitor.clock_skewed(0), 1u);
+    EXPECT_EQ(monitor.last_lag_ns(0), 0);
+    EXPECT_EQ(monitor.lag_histogram(0).max(), 0u);
+}
+
+TEST(FeedLatencyMonitorTest, StaleWithoutTicksOrWithLargeLag) {
+    FeedLatencyMonitor monitor({"BTC-USD", "ETH-USD"}, 5 * SECOND_NS, 2000 * MS_NS);
+
+    // Products that never ticked go stale stale_after_ns after construction
+    int64_t start_ns = monitor.last_receive_ns(1);
+    EXPECT_FALSE(monitor.stale(1, start_ns + 5 * SECOND_NS));
+    EXPECT_TRUE(monitor.stale(1, start_ns + 5 * SECOND_NS + 1));
+
+    monitor.record(0, EXCHANGE_NS + 100 * MS_NS, EXCHANGE_NS, EXCHANGE_NS + 100 * MS_NS);
+    EXPECT_FALSE(monitor.stale(0, EXCHANGE_NS + SECOND_NS));
+    EXPECT_TRUE(monitor.stale(0, EXCHANGE_NS + 6 * SECOND_NS));
+
+    // Fresh but far behind the exchange
+    monitor.record(0, EXCHANGE_NS + 3 * SECOND_NS, EXCHANGE_NS, EXCHANGE_NS + 3 * SECOND_NS);
+    EXPECT_TRUE(monitor.stale(0, EXCHANGE_NS + 3 * SECOND_NS));
+
+    // Caught up again
+    monitor.record(0, EXCHANGE_NS + 4 * SECOND_NS, EXCHANGE_NS + 4 * SECOND_NS - MS_NS, EXCHANGE_NS + 4 * SECOND_NS);
+    EXPECT_FALSE(monitor.stale(0, EXCHANGE_NS + 4 * SECOND_NS));
+}
+
+TEST(FeedLatencyMonitorTest, ParserStampsReceiveTimeAndRecordsLag) {
+    static_assert(Tick::has(tick_fields::RECEIVE_TIME) && !SlimTick::has(tick_fields::RECEIVE_TIME));
+
+    TickRingBuffer ring;
+    TickParser parser(ring, {"BTC-USD"});
+    FeedLatencyMonitor monitor({"BTC-USD"}, 5 * SECOND_NS, 2000 * MS_NS);
+    parser.set_latency_monitor(&monitor);
+
+    int64_t receive_ns = EXCHANGE_NS + 25 * MS_NS;
+    parser.set_receive_time(receive_ns);
+    simdjson::padded_string payload(std::string(
+        R"({"type": "ticker", "product_id": "BTC-USD", "price": "100", "time": "2025-09-07T08:47:52.369411Z"})"));
+    ASSERT_TRUE(parser.parse_and_push(payload));
+
+    Tick* tick = ring.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_EQ(tick->receive_time_ns, receive_ns);
+    ring.release_slot();
+
+    EXPECT_EQ(monitor.last_lag_ns(0), 25 * MS_NS);
+    EXPECT_EQ(monitor.lag_histogram(0).count(), 1u);
+    EXPECT_EQ(monitor.stack_histogram(0).count(), 1u);
+}
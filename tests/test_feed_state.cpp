@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "sparkland/feed_state.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace sparkland;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int64_t SECOND_NS = 1000000000;
+
+ProductState product_state(const char* product_id, double price_ema, int64_t ema_update_ns, uint64_t sequence) {
+    ProductState state{};
+    std::snprintf(state.product_id, sizeof(state.product_id), "%s", product_id);
+    state.top.price = Decimal64(10000, 2);
+    state.top.price_ema = price_ema;
+    state.top.mid_price_ema = price_ema - 0.5;
+    state.top.sequence = sequence;
+    state.ema_update_ns = ema_update_ns;
+    return state;
+}
+
+std::string ticker(const char* price) {
+    return std::string(R"({"type": "ticker", "sequence": 42, "product_id": "BTC-USD", "price": ")") + price +
+           R"(", "best_bid": "99", "best_ask": "101", "last_size": "1"})";
+}
+
+}
+
+class FeedStateTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string dir = "test_feed_state";
+    std::string path = dir + "/feed_state.bin";
+    int64_t now_ns = 1757234872 * SECOND_NS;
+};
+
+TEST_F(FeedStateTest, RoundTrip) {
+    FeedState state;
+    state.written_ns = now_ns;
+    state.ema_period_s = 5.0;
+    state.products = {product_state("BTC-USD", 100.25, now_ns - SECOND_NS, 77),
+                      product_state("ETH-USD", 0.0, 0, 0)};
+    ASSERT_TRUE(write_feed_state(path, state));
+    EXPECT_FALSE(fs::exists(path + ".tmp"));
+
+    FeedState loaded;
+    std::string error;
+    ASSERT_TRUE(read_feed_state(path, 5.0, now_ns + SECOND_NS, 60 * SECOND_NS, loaded, error)) << error;
+    EXPECT_EQ(loaded.written_ns, now_ns);
+    ASSERT_EQ(loaded.products.size(), 2u);
+    EXPECT_STREQ(loaded.products[0].product_id, "BTC-USD");
+    EXPECT_DOUBLE_EQ(loaded.products[0].top.price_ema, 100.25);
+    EXPECT_EQ(loaded.products[0].top.price, Decimal64(10000, 2));
+    EXPECT_EQ(loaded.products[0].top.sequence, 77u);
+    EXPECT_EQ(loaded.products[0].ema_update_ns, now_ns - SECOND_NS);
+    EXPECT_EQ(loaded.products[1].ema_update_ns, 0);
+}
+
+TEST_F(FeedStateTest, RejectsStaleCorruptAndMismatchedSnapshots) {
+    FeedState state;
+    state.written_ns = now_ns;
+    state.ema_period_s = 5.0;
+    state.products = {product_state("BTC-USD", 100.25, now_ns, 77)};
+    ASSERT_TRUE(write_feed_state(path, state));
+
+    FeedState loaded;
+    std::string error;
+    EXPECT_FALSE(read_feed_state(dir + "/missing.bin", 5.0, now_ns, 60 * SECOND_NS, loaded, error));
+    EXPECT_FALSE(read_feed_state(path, 5.0, now_ns + 61 * SECOND_NS, 60 * SECOND_NS, loaded, error));
+    EXPECT_NE(error.find("stale"), std::string::npos);
+    EXPECT_FALSE(read_feed_state(path, 30.0, now_ns, 60 * SECOND_NS, loaded, error));
+
+    // Flip a byte of the record
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-8, std::ios::end);
+        file.put('\x7f');
+    }
+    EXPECT_FALSE(read_feed_state(path, 5.0, now_ns, 60 * SECOND_NS, loaded, error));
+    EXPECT_NE(error.find("corrupt"), std::string::npos);
+
+    // Cut off
+    fs::resize_file(path, 20);
+    EXPECT_FALSE(read_feed_state(path, 5.0, now_ns, 60 * SECOND_NS, loaded, error));
+    EXPECT_TRUE(loaded.products.empty());
+}
+
+TEST_F(FeedStateTest, SnapshotterWritesStagedStateOffThread) {
+    FeedStateSnapshotter snapshotter(path, {"BTC-USD", "ETH-USD"}, 5.0, SECOND_NS);
+    EXPECT_EQ(snapshotter.index_of("ETH-USD"), 1);
+    EXPECT_EQ(snapshotter.index_of("SOL-USD"), -1);
+    snapshotter.start();
+
+    snapshotter.stage(0) = product_state("BTC-USD", 101.0, now_ns, 5);
+    snapshotter.stop();
+    EXPECT_EQ(snapshotter.written(), 1u);  // final state on stop
+
+    FeedState loaded;
+    std::string error;
+    ASSERT_TRUE(read_feed_state(path, 5.0, wall_clock_ns(), 60 * SECOND_NS, loaded, error)) << error;
+    ASSERT_EQ(loaded.products.size(), 2u);
+    EXPECT_DOUBLE_EQ(loaded.products[0].top.price_ema, 101.0);
+    EXPECT_STREQ(loaded.products[1].product_id, "ETH-USD");
+}
+
+TEST_F(FeedStateTest, ParserRestoresWarmEma) {
+    TickRingBuffer ring;
+    SnapshotCache cache({"BTC-USD"});
+    FeedStateSnapshotter snapshotter(path, {"BTC-USD"}, 5.0, SECOND_NS);
+    TickParser parser(ring, {"BTC-USD"}, &cache);
+    parser.set_snapshotter(&snapshotter);
+
+    // Updated right before the restart, the EMA continues instead of starting at the first price
+    FeedState state;
+    state.written_ns = now_ns;
+    state.products = {product_state("BTC-USD", 100.0, now_ns, 41), product_state("DOGE-USD", 1.0, now_ns, 1)};
+    EXPECT_EQ(parser.restore(state, now_ns), 1u);
+
+    TopOfBook top;
+    ASSERT_TRUE(cache.read("BTC-USD", top));
+    EXPECT_EQ(top.sequence, 41u);
+
+    parser.set_receive_time(now_ns);
+    simdjson::padded_string payload(ticker("200"));
+    ASSERT_TRUE(parser.parse_and_push(payload));
+    Tick* tick = ring.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_GT(tick->price_ema, 100.0);
+    EXPECT_LT(tick->price_ema, 150.0);
+
+    // Staged for the next snapshot
+    EXPECT_EQ(snapshotter.stage(0).top.sequence, 42u);
+    EXPECT_DOUBLE_EQ(snapshotter.stage(0).top.price_ema, tick->price_ema);
+    EXPECT_EQ(snapshotter.stage(0).ema_update_ns, now_ns);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "sparkland/huge_pages.h"
+#include "sparkland/ring_buffer.h"
+#include "sparkland/broadcast_ring.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+using namespace sparkland;
+
+namespace {
+
+// From <numaif.h>, which is part of libnuma and not always installed
+constexpr int MPOL_F_NODE = 1 << 0;
+constexpr int MPOL_F_ADDR = 1 << 1;
+
+}
+
+TEST(HugePagesTest, SmallRegionUsesRegularPages) {
+    HugePageRegion region(100);
+    ASSERT_NE(region.data(), nullptr);
+    EXPECT_EQ(region.size(), 100u);
+    EXPECT_EQ(region.backing(), PageBacking::Regular);
+    EXPECT_GE(region.mapped_size(), 100u);
+}
+
+TEST(HugePagesTest, LargeRegionIsHugePageAligned) {
+    HugePageRegion region(3 * HUGE_PAGE_SIZE + 1);
+    ASSERT_NE(region.data(), nullptr);
+    EXPECT_EQ(region.mapped_size(), 4 * HUGE_PAGE_SIZE);
+    // Whatever the machine supports, the range is aligned so huge pages can back it
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(region.data()) % HUGE_PAGE_SIZE, 0u);
+
+    // Zero filled and writable end to end
+    auto* bytes = static_cast<unsigned char*>(region.data());
+    EXPECT_EQ(bytes[0], 0);
+    EXPECT_EQ(bytes[region.size() - 1], 0);
+    std::memset(bytes, 0xab, region.size());
+    EXPECT_EQ(bytes[region.size() - 1], 0xab);
+}
+
+TEST(HugePagesTest, NumaPreferenceOnLocalNode) {
+    int node = current_numa_node();
+    HugePageRegion region(HUGE_PAGE_SIZE, node);
+    static_cast<char*>(region.data())[0] = 1;
+    EXPECT_EQ(numa_node_of_cpu(-1), -1);
+    if (node < 0) {
+        EXPECT_EQ(region.numa_node(), -1);
+        return;
+    }
+
+    // mbind succeeded and the touched page came from the preferred node
+    EXPECT_EQ(region.numa_node(), node);
+    int page_node = -1;
+    ASSERT_EQ(syscall(SYS_get_mempolicy, &page_node, nullptr, 0, region.data(), MPOL_F_NODE | MPOL_F_ADDR), 0)
+        << std::strerror(errno);
+    EXPECT_EQ(page_node, node);
+}
+
+TEST(HugePagesTest, RingsLiveInRegions) {
+    // A million slot ring, far too big for a stack frame
+    RingBuffer<uint64_t, 1 << 20> ring;
+    EXPECT_EQ(ring.memory().data(), ring.storage());
+    EXPECT_GE(ring.memory().mapped_size(), ring.storage_bytes());
+    uint64_t* slot = ring.acquire_free_slot();
+    ASSERT_NE(slot, nullptr);
+    *slot = 42;
+    ring.publish_slot();
+    EXPECT_EQ(*ring.acquire_filled_slot(), 42u);
+
+    BroadcastRing<uint64_t, 64> broadcast(1 << 20, current_numa_node());
+    EXPECT_EQ(broadcast.memory().data(), broadcast.storage());
+    EXPECT_EQ(broadcast.storage_bytes(), (1u << 20) * sizeof(uint64_t));
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "sparkland/latency_histogram.h"
+
+using namespace sparkland;
+
+TEST(LatencyHistogramTest, EmptyHistogram) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(0.99), 0u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 0.0);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 50; ++value) histogram.record(value);
+
+    EXPECT_EQ(histogram.count(), 50u);
+    EXPECT_EQ(histogram.min(), 1u);
+    EXPECT_EQ(histogram.max(), 50u);
+    EXPECT_EQ(histogram.percentile(0.5), 25u);
+    EXPECT_EQ(histogram.percentile(1.0), 50u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 25.5);
+}
+
+TEST(LatencyHistogramTest, LargeValuesWithinRelativeError) {
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) histogram.record(value * 1000);
+
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double expected = q * 100000 * 1000;
+        double actual = static_cast<double>(histogram.percentile(q));
+        EXPECT_GE(actual, expected * 0.99) << "q " << q;
+        EXPECT_LE(actual, expected * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKETS)) << "q " << q;
+    }
+    EXPECT_EQ(histogram.percentile(1.0), 100000u * 1000);
+
+    // Extremes still land in a bucket
+    histogram.record(UINT64_MAX);
+    EXPECT_EQ(histogram.max(), UINT64_MAX);
+    EXPECT_EQ(histogram.percentile(1.0), UINT64_MAX);
+}
+
+TEST(LatencyHistogramTest, MergeCombinesCounts) {
+    LatencyHistogram first;
+    LatencyHistogram second;
+    for (int i = 0; i < 90; ++i) first.record(10);
+    for (int i = 0; i < 10; ++i) second.record(5000);
+
+    first.merge(second);
+    EXPECT_EQ(first.count(), 100u);
+    EXPECT_EQ(first.percentile(0.9), 10u);
+    EXPECT_GE(first.percentile(0.95), 5000u);
+    EXPECT_EQ(first.max(), 5000u);
+    EXPECT_EQ(first.min(), 10u);
+
+    first.reset();
+    EXPECT_EQ(first.count(), 0u);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <websocketpp/message_buffer/message.hpp>
+#include "sparkland/arena.h"
+#include "sparkland/message_pool.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Counting allocator: replaces the global operator new for the whole test binary,
+// but only counts while a test has switched counting on for its thread
+namespace {
+thread_local bool counting = false;
+std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new(size_t size) {
+    if (counting) allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// GCC pairs the inlined malloc/free with new/delete expressions and warns
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+using namespace sparkland;
+
+using PooledMessage = websocketpp::message_buffer::message<RecyclingMessageManager>;
+using PooledManager = RecyclingMessageManager<PooledMessage>;
+
+TEST(MessagePoolTest, ReusesReleasedMessages) {
+    auto manager = websocketpp::lib::make_shared<PooledManager>();
+
+    auto first = manager->get_message(websocketpp::frame::opcode::text, 100);
+    PooledMessage* address = first.get();
+    first->get_raw_payload() = "payload";
+    first.reset();
+
+    auto second = manager->get_message(websocketpp::frame::opcode::binary, 50);
+    EXPECT_EQ(second.get(), address);
+    EXPECT_TRUE(second->get_payload().empty());
+    EXPECT_EQ(second->get_opcode(), websocketpp::frame::opcode::binary);
+    EXPECT_GE(second->get_raw_payload().capacity(), 50 + simdjson::SIMDJSON_PADDING);
+
+    // Still referenced, so a new one is handed out
+    auto third = manager->get_message(websocketpp::frame::opcode::text, 10);
+    EXPECT_NE(third.get(), address);
+    EXPECT_EQ(manager->reused(), 1u);
+    EXPECT_EQ(manager->allocated(), 2u);
+}
+
+TEST(MessagePoolTest, ArenaResetsPerMessage) {
+    Arena arena(1024);
+    void* a = arena.allocate(600);
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(arena.allocate(600), nullptr);
+    EXPECT_EQ(arena.failed(), 1u);
+
+    arena.reset();
+    EXPECT_EQ(arena.allocate(600), a);
+    EXPECT_EQ(arena.high_water(), 600u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(arena.allocate(1, 64)) % 64, 0u);
+}
+
+TEST(MessagePoolTest, SteadyStateMessagesDoNotAllocate) {
+    auto manager = websocketpp::lib::make_shared<PooledManager>();
+    TickRingBuffer ring;
+    TickParser parser(ring, {"BTC-USD"});
+
+    const std::string frame = R"({"type":"ticker","sequence":1,"product_id":"BTC-USD","price":"110000.5",)"
+                              R"("open_24h":"108000","volume_24h":"1200.5","low_24h":"107000","high_24h":"111000",)"
+                              R"("volume_30d":"30000","best_bid":"110000.4","best_bid_size":"0.5",)"
+                              R"("best_ask":"110000.6","best_ask_size":"0.25","side":"buy",)"
+                              R"("time":"2025-01-01T00:00:00.000000Z","trade_id":42,"last_size":"0.01"})";
+
+    // Same path as CoinbaseClient::on_message: the connection fills a pooled message,
+    // the handler parses it in place and the message goes back to the pool
+    auto deliver = [&]() {
+        auto msg = manager->get_message(websocketpp::frame::opcode::text, frame.size());
+        msg->get_raw_payload().append(frame);
+
+        simdjson::padded_string_view payload;
+        ASSERT_TRUE(padded_view(msg->get_raw_payload(), payload));
+        ASSERT_TRUE(parser.parse_and_push(payload));
+
+        Tick* tick = ring.acquire_filled_slot();
+        ASSERT_NE(tick, nullptr);
+        ring.release_slot();
+    };
+
+    // Warm up: pool entries, parser buffers
+    for (int i = 0; i < 10; ++i) deliver();
+
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < 1000; ++i) deliver();
+    counting = false;
+
+    EXPECT_EQ(allocations.load(), 0u);
+    EXPECT_EQ(manager->allocated(), 1u);
+}
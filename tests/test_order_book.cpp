@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "sparkland/order_book.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <random>
+#include <map>
+
+using namespace sparkland;
+
+namespace {
+
+Decimal64 dec(const char* str) {
+    Decimal64 value;
+    Decimal64::parse(str, value);
+    return value;
+}
+
+}
+
+TEST(OrderBookTest, LevelsSortedFromTouch) {
+    OrderBook book(2);
+    book.apply(Side::Buy, dec("100.00"), dec("1"));
+    book.apply(Side::Buy, dec("101.00"), dec("2"));
+    book.apply(Side::Buy, dec("99.50"), dec("3"));
+    book.apply(Side::Sell, dec("102.00"), dec("4"));
+    book.apply(Side::Sell, dec("101.50"), dec("5"));
+
+    ASSERT_EQ(book.depth(Side::Buy), 3u);
+    ASSERT_EQ(book.depth(Side::Sell), 2u);
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 0)), dec("101"));
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 1)), dec("100"));
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 2)), dec("99.5"));
+    EXPECT_EQ(book.price_of(book.level(Side::Sell, 0)), dec("101.5"));
+    EXPECT_EQ(book.level(Side::Sell, 1).size, dec("4"));
+    EXPECT_EQ(book.mid_price(), dec("101.25"));
+}
+
+TEST(OrderBookTest, UpdateAndRemoveLevels) {
+    OrderBook book;
+    book.apply(Side::Buy, dec("100.00"), dec("1"));
+    book.apply(Side::Buy, dec("100.00000000"), dec("2.5"));  // same level, different wire scale
+    ASSERT_EQ(book.depth(Side::Buy), 1u);
+    EXPECT_EQ(book.level(Side::Buy, 0).size, dec("2.5"));
+
+    book.apply(Side::Buy, dec("100"), dec("0.00000000"));
+    EXPECT_EQ(book.depth(Side::Buy), 0u);
+
+    // Removing an unknown level is a no-op
+    book.apply(Side::Sell, dec("105"), dec("0"));
+    EXPECT_EQ(book.depth(Side::Sell), 0u);
+    EXPECT_FALSE(book.has_top());
+    EXPECT_EQ(book.updates(), 4u);
+}
+
+TEST(OrderBookTest, PriceTooLargeForScaleIsRejected) {
+    OrderBook book(8);
+    EXPECT_FALSE(book.apply(Side::Buy, dec("99999999999"), dec("1")));
+    EXPECT_EQ(book.depth(Side::Buy), 0u);
+    EXPECT_EQ(book.updates(), 0u);
+    EXPECT_TRUE(book.apply(Side::Buy, dec("99999999"), dec("1")));
+
+    book.begin_snapshot();
+    EXPECT_FALSE(book.stage_level(Side::Sell, dec("99999999999"), dec("1")));
+}
+
+TEST(OrderBookTest, MicropriceAndWeightedMid) {
+    OrderBook book(2);
+    book.apply(Side::Buy, dec("100"), dec("3"));
+    book.apply(Side::Sell, dec("101"), dec("1"));
+
+    // Heavier bid pulls towards the ask: (100 * 1 + 101 * 3) / 4
+    EXPECT_DOUBLE_EQ(book.microprice(), 100.75);
+
+    book.apply(Side::Buy, dec("99"), dec("1"));
+    book.apply(Side::Sell, dec("102"), dec("3"));
+    // bid vwap = 99.75 (qty 4), ask vwap = 101.75 (qty 4)
+    EXPECT_DOUBLE_EQ(book.weighted_mid(2), 100.75);
+    EXPECT_DOUBLE_EQ(book.weighted_mid(10), 100.75);
+    EXPECT_DOUBLE_EQ(book.microprice(), 100.75);
+}
+
+TEST(OrderBookTest, MatchesReferenceBookUnderRandomUpdates) {
+    OrderBook book(2);
+    std::map<int64_t, int64_t> bids;
+    std::map<int64_t, int64_t> asks;
+    std::mt19937 rng(7);
+
+    for (int i = 0; i < 20000; ++i) {
+        bool buy = rng() % 2;
+        // Concentrated near the touch with occasional deep levels
+        int64_t offset = (rng() % 10 == 0) ? rng() % 5000 : rng() % 40;
+        int64_t price = buy ? 1000000 - offset : 1000001 + offset;
+        int64_t size = (rng() % 4 == 0) ? 0 : 1 + rng() % 1000;
+
+        book.apply(buy ? Side::Buy : Side::Sell, Decimal64(price, 2), Decimal64(size, 0));
+        auto& ref = buy ? bids : asks;
+        if (size == 0) ref.erase(price); else ref[price] = size;
+    }
+
+    ASSERT_EQ(book.depth(Side::Buy), bids.size());
+    ASSERT_EQ(book.depth(Side::Sell), asks.size());
+    size_t i = 0;
+    for (auto it = bids.rbegin(); it != bids.rend(); ++it, ++i) {
+        EXPECT_EQ(book.level(Side::Buy, i).price, it->first);
+        EXPECT_EQ(book.level(Side::Buy, i).size.units(), it->second);
+    }
+    i = 0;
+    for (auto it = asks.begin(); it != asks.end(); ++it, ++i) {
+        EXPECT_EQ(book.level(Side::Sell, i).price, it->first);
+    }
+}
+
+TEST(OrderBookTest, SnapshotReplacesBookInOneStep) {
+    OrderBook book(2);
+    book.apply(Side::Buy, dec("50"), dec("1"));
+
+    // Best first like the feed, with a repeated price (last one wins) and an empty level
+    book.begin_snapshot();
+    book.stage_level(Side::Buy, dec("101"), dec("1"));
+    book.stage_level(Side::Buy, dec("100"), dec("2"));
+    book.stage_level(Side::Buy, dec("100"), dec("3"));
+    book.stage_level(Side::Buy, dec("99"), dec("0"));
+    book.stage_level(Side::Buy, dec("98"), dec("4"));
+    // Out of order side, sorted
+    book.stage_level(Side::Sell, dec("103"), dec("5"));
+    book.stage_level(Side::Sell, dec("102"), dec("6"));
+    EXPECT_EQ(book.depth(Side::Buy), 1u);  // nothing applied before the commit
+    book.commit_snapshot();
+
+    ASSERT_EQ(book.depth(Side::Buy), 3u);
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 0)), dec("101"));
+    EXPECT_EQ(book.level(Side::Buy, 1).size, dec("3"));
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 2)), dec("98"));
+    ASSERT_EQ(book.depth(Side::Sell), 2u);
+    EXPECT_EQ(book.price_of(book.level(Side::Sell, 0)), dec("102"));
+
+    // Per-level updates continue on the snapshot
+    book.apply(Side::Buy, dec("100.5"), dec("7"));
+    EXPECT_EQ(book.price_of(book.level(Side::Buy, 1)), dec("100.5"));
+
+    // An abandoned snapshot leaves the book alone and is dropped by the next one
+    book.begin_snapshot();
+    book.stage_level(Side::Buy, dec("1"), dec("1"));
+    EXPECT_EQ(book.depth(Side::Buy), 4u);
+    book.begin_snapshot();
+    book.stage_level(Side::Sell, dec("110"), dec("1"));
+    book.commit_snapshot();
+    EXPECT_EQ(book.depth(Side::Buy), 0u);
+    EXPECT_EQ(book.depth(Side::Sell), 1u);
+}
+
+TEST(OrderBookTest, TickParserAppliesLevel2Messages) {
+    std::vector<std::string> products = {"BTC-USD"};
+    TickRingBuffer ring_buffer;
+    SnapshotCache cache(products);
+    TickParser parser(ring_buffer, products, &cache);
+
+    simdjson::padded_string snapshot(std::string(R"({
+        "type": "snapshot",
+        "product_id": "BTC-USD",
+        "bids": [["10101.10", "0.45054140"], ["10101.00", "1.0"]],
+        "asks": [["10102.55", "0.57753524"]]
+    })"));
+    ASSERT_TRUE(parser.parse_and_push(snapshot));
+
+    simdjson::padded_string update(std::string(R"({
+        "type": "l2update",
+        "product_id": "BTC-USD",
+        "time": "2019-08-14T20:42:27.265Z",
+        "changes": [["buy", "10101.80000000", "0.162567"], ["sell", "10102.55000000", "0.00000000"],
+                    ["sell", "10103.00", "2.0"]]
+    })"));
+    ASSERT_TRUE(parser.parse_and_push(update));
+
+    // Book messages never reach the tick ring
+    EXPECT_TRUE(ring_buffer.empty());
+
+    const OrderBook* book = parser.book("BTC-USD");
+    ASSERT_NE(book, nullptr);
+    EXPECT_EQ(book->depth(Side::Buy), 3u);
+    EXPECT_EQ(book->depth(Side::Sell), 1u);
+    EXPECT_EQ(book->price_of(book->level(Side::Buy, 0)), dec("10101.8"));
+    EXPECT_EQ(book->price_of(book->level(Side::Sell, 0)), dec("10103"));
+
+    TopOfBook top;
+    ASSERT_TRUE(cache.read("BTC-USD", top));
+    EXPECT_EQ(top.best_bid, dec("10101.8"));
+    EXPECT_EQ(top.best_ask_size, dec("2"));
+    EXPECT_DOUBLE_EQ(top.microprice, book->microprice());
+    EXPECT_GT(top.microprice, 10101.8);
+    EXPECT_LT(top.microprice, 10103.0);
+    EXPECT_GT(top.microprice_ema, 0.0);
+
+    // Unknown products are ignored, malformed levels rejected
+    simdjson::padded_string other(std::string(R"({"type": "l2update", "product_id": "DOGE-USD", "changes": [["buy", "1", "1"]]})"));
+    EXPECT_TRUE(parser.parse_and_push(other));
+    simdjson::padded_string bad(std::string(R"({"type": "l2update", "product_id": "BTC-USD", "changes": [["buy", "abc", "1"]]})"));
+    EXPECT_FALSE(parser.parse_and_push(bad));
+
+    // A snapshot that fails half way doesn't leave a partial book behind
+    simdjson::padded_string bad_snapshot(std::string(R"({
+        "type": "snapshot",
+        "product_id": "BTC-USD",
+        "bids": [["10105.00", "1.0"], ["10104.00"]],
+        "asks": [["10106.00", "1.0"]]
+    })"));
+    EXPECT_FALSE(parser.parse_and_push(bad_snapshot));
+    EXPECT_EQ(book->depth(Side::Buy), 3u);
+    EXPECT_EQ(book->price_of(book->level(Side::Buy, 0)), dec("10101.8"));
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "sparkland/segmented_file.h"
+#include "sparkland/csv_logger.h"
+#include <zlib.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sparkland;
+namespace fs = std::filesystem;
+
+class SegmentedFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    static std::string read_file(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    std::string dir = "test_segments";
+    std::string base = dir + "/ticks.csv";
+};
+
+TEST_F(SegmentedFileTest, SegmentNamesAreDeterministic) {
+    // 2025-10-18T14:00:00Z
+    std::time_t period = 1760796000;
+    EXPECT_EQ(segment_path("out/ticks.csv", 3600, period, 3), "out/ticks.20251018T140000Z.0003.csv");
+    EXPECT_EQ(segment_path("out/ticks.csv", 0, 0, 12), "out/ticks.0012.csv");
+    EXPECT_EQ(segment_path("ticks", 0, 0, 0), "ticks.0000");
+    EXPECT_EQ(segment_path("out.d/ticks", 0, 0, 1), "out.d/ticks.0001");
+}
+
+TEST_F(SegmentedFileTest, AppendNeverTruncates) {
+    {
+        SegmentedFile file(base, OutputPolicy());
+        EXPECT_TRUE(file.needs_header());
+        file.stream() << "header\nrow1\n";
+        file.header_written();
+    }
+    {
+        SegmentedFile file(base, OutputPolicy());
+        EXPECT_EQ(file.current_path(), base);
+        EXPECT_FALSE(file.needs_header());
+        file.stream() << "row2\n";
+    }
+    EXPECT_EQ(read_file(base), "header\nrow1\nrow2\n");
+}
+
+TEST_F(SegmentedFileTest, NewSegmentModeStartsNextIndex) {
+    OutputPolicy policy;
+    policy.open_mode = OpenMode::NewSegment;
+    {
+        SegmentedFile file(base, policy);
+        EXPECT_EQ(file.current_path(), dir + "/ticks.0000.csv");
+        file.stream() << "first\n";
+    }
+    {
+        SegmentedFile file(base, policy);
+        EXPECT_EQ(file.current_path(), dir + "/ticks.0001.csv");
+        EXPECT_TRUE(file.needs_header());
+    }
+
+    // Append mode continues the latest segment instead
+    policy.open_mode = OpenMode::Append;
+    policy.max_bytes = 1024 * 1024;
+    SegmentedFile file(base, policy);
+    EXPECT_EQ(file.current_path(), dir + "/ticks.0001.csv");
+}
+
+TEST_F(SegmentedFileTest, RotatesBySize) {
+    OutputPolicy policy;
+    policy.max_bytes = 100;
+    SegmentedFile file(base, policy);
+    EXPECT_EQ(file.current_path(), dir + "/ticks.0000.csv");
+
+    // The size is only looked at every ROTATION_CHECK_RECORDS records
+    bool rotated = false;
+    for (uint32_t i = 0; i < ROTATION_CHECK_RECORDS && !rotated; ++i) {
+        file.stream() << "0123456789\n";
+        rotated = file.record_written();
+    }
+    EXPECT_TRUE(rotated);
+    EXPECT_EQ(file.current_path(), dir + "/ticks.0001.csv");
+    EXPECT_TRUE(file.needs_header());
+    EXPECT_EQ(file.segments_opened(), 2u);
+    EXPECT_EQ(fs::file_size(dir + "/ticks.0000.csv"), 11u * ROTATION_CHECK_RECORDS);
+}
+
+TEST_F(SegmentedFileTest, CompressesClosedSegments) {
+    const std::string path = dir + "/ticks.0000.csv";
+    std::string content;
+    for (int i = 0; i < 10000; ++i) content += "BTC-USD,111000.12,0.5\n";
+    std::ofstream(path) << content;
+
+    SegmentCompressor compressor;
+    compressor.submit(path);
+    compressor.stop();
+    EXPECT_EQ(compressor.compressed(), 1u);
+    EXPECT_FALSE(fs::exists(path));
+    ASSERT_TRUE(fs::exists(path + ".gz"));
+    EXPECT_LT(fs::file_size(path + ".gz"), content.size() / 10);
+
+    // Round trip
+    gzFile in = gzopen((path + ".gz").c_str(), "rb");
+    ASSERT_NE(in, nullptr);
+    std::string restored(content.size() + 1, '\0');
+    int read = gzread(in, restored.data(), static_cast<unsigned>(restored.size()));
+    gzclose(in);
+    restored.resize(read > 0 ? static_cast<size_t>(read) : 0);
+    EXPECT_EQ(restored, content);
+
+    // A compressed segment keeps its index taken
+    OutputPolicy policy;
+    policy.max_bytes = 1024;
+    SegmentedFile file(base, policy);
+    EXPECT_EQ(file.current_path(), dir + "/ticks.0001.csv");
+}
+
+TEST_F(SegmentedFileTest, LoggerRestartKeepsData) {
+    for (int run = 0; run < 2; ++run) {
+        BarRingBuffer ring;
+        Bar* bar = ring.acquire_free_slot();
+        ASSERT_NE(bar, nullptr);
+        *bar = Bar{};
+        std::snprintf(bar->product_id, sizeof(bar->product_id), "BTC-USD");
+        bar->interval_s = 1;
+        ring.publish_slot();
+        ring.close();
+
+        BarCSVLogger logger(ring, base);
+        logger.start();
+        DrainStats stats = logger.stop();
+        EXPECT_EQ(stats.written, 1u);
+        EXPECT_TRUE(stats.reached_end);
+        EXPECT_TRUE(stats.synced);
+    }
+
+    std::string content = read_file(base);
+    EXPECT_EQ(content.rfind("product_id,", 0), 0u);
+    EXPECT_EQ(content.find("product_id,", 1), std::string::npos);  // header written once
+    size_t rows = 0;
+    for (char c : content) rows += c == '\n';
+    EXPECT_EQ(rows, 3u);
+}
+
+TEST_F(SegmentedFileTest, LoggerDrainsTicksPublishedDuringStop) {
+    BarRingBuffer ring;
+    BarCSVLogger logger(ring, base, WaitStrategy::Yield);
+    logger.start();
+
+    // The producer is still publishing when stop() is called, nothing is cut off
+    std::thread producer([&ring]() {
+        for (int i = 0; i < 500; ++i) {
+            Bar* bar;
+            while (!(bar = ring.acquire_free_slot())) std::this_thread::yield();
+            *bar = Bar{};
+            bar->trade_count = static_cast<uint64_t>(i);
+            ring.publish_slot();
+        }
+        ring.close();
+    });
+    DrainStats stats = logger.stop(std::chrono::steady_clock::now() + std::chrono::seconds(10));
+    producer.join();
+
+    EXPECT_EQ(stats.written, 500u);
+    EXPECT_EQ(stats.abandoned, 0u);
+    EXPECT_TRUE(stats.reached_end);
+    EXPECT_TRUE(stats.synced);
+
+    size_t rows = 0;
+    for (char c : read_file(base)) rows += c == '\n';
+    EXPECT_EQ(rows, 501u);
+}
+
+TEST_F(SegmentedFileTest, LoggerStopsAtDeadlineWithoutEndOfStream) {
+    BarRingBuffer ring;
+    BarCSVLogger logger(ring, base);
+    logger.start();
+
+    // The ring is never closed: stop() gives up at the deadline and still syncs the output
+    auto start = std::chrono::steady_clock::now();
+    DrainStats stats = logger.stop(start + std::chrono::milliseconds(50));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    EXPECT_FALSE(stats.reached_end);
+    EXPECT_TRUE(stats.synced);
+    EXPECT_EQ(logger.stop().written, stats.written);  // later calls return the same stats
+}
+
+TEST_F(SegmentedFileTest, LoggerDestructorDoesNotWaitForEndOfStream) {
+    BarRingBuffer ring;
+    auto start = std::chrono::steady_clock::now();
+    {
+        BarCSVLogger logger(ring, base);
+        logger.start();
+        // Destroyed without stop() and without an end of stream, e.g. on an exception path
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, DEFAULT_DRAIN_TIMEOUT / 2);
+    EXPECT_EQ(read_file(base).rfind("product_id,", 0), 0u);
+}
+
+TEST_F(SegmentedFileTest, LoggerSkipsTornRowsOfDropConsumer) {
+    // Two slots and a producer that never waits: the writer is lapped mid-read all the time
+    TickBroadcastRing ring(2);
+    auto& consumer = ring.add_consumer(LagPolicy::Drop);
+    BroadcastCSVLogger logger(consumer, base, WaitStrategy::Yield);
+    logger.start();
+
+    // Every field of tick n carries n, a torn copy mixes two ticks
+    std::thread producer([&ring]() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        for (int64_t n = 1; std::chrono::steady_clock::now() < end; ++n) {
+            Tick* tick = ring.acquire_free_slot();
+            tick->sequence = static_cast<uint64_t>(n);
+            tick->price = Decimal64(n, 0);
+            tick->best_bid = Decimal64(n, 0);
+            tick->best_ask_size = Decimal64(n, 0);
+            ring.publish_slot();
+            // Let the writer in every full lap, so it is also lapped when preempted mid-row
+            if (n % 2 == 0) std::this_thread::yield();
+        }
+        ring.close();
+    });
+    producer.join();
+    DrainStats stats = logger.stop();
+    ASSERT_TRUE(stats.reached_end);
+
+    std::istringstream rows(read_file(base));
+    std::string row;
+    std::getline(rows, row);  // header
+    uint64_t written = 0;
+    while (std::getline(rows, row)) {
+        std::vector<std::string> fields;
+        std::istringstream cells(row);
+        for (std::string cell; std::getline(cells, cell, ',');) fields.push_back(cell);
+        ASSERT_GT(fields.size(), 12u) << row;
+        // sequence, price, best_bid, best_ask_size
+        EXPECT_EQ(fields[1], fields[3]) << row;
+        EXPECT_EQ(fields[1], fields[9]) << row;
+        EXPECT_EQ(fields[1], fields[12]) << row;
+        ++written;
+    }
+    EXPECT_EQ(written, stats.written);
+    EXPECT_GT(stats.written, 0u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "sparkland/shm_bus.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace sparkland;
+
+namespace {
+
+const std::string BUS_NAME = "/sparkland-test-" + std::to_string(getpid());
+
+SlimTick make_tick(const char* product, uint64_t sequence) {
+    SlimTick tick{};
+    std::snprintf(tick.product_id, sizeof(tick.product_id), "%s", product);
+    tick.sequence = sequence;
+    tick.price = Decimal64(static_cast<int64_t>(sequence), 0);
+    return tick;
+}
+
+}
+
+TEST(ShmBusTest, ReaderSeesTicksAndLatestValues) {
+    ShmTickBus<SlimTick> bus(BUS_NAME, {"BTC-USD", "ETH-USD"}, 8);
+    ShmTickBusReader<SlimTick> reader(BUS_NAME);
+    EXPECT_EQ(reader.product_ids(), (std::vector<std::string>{"BTC-USD", "ETH-USD"}));
+    EXPECT_EQ(reader.producer_pid(), static_cast<uint32_t>(getpid()));
+    EXPECT_TRUE(reader.empty());
+
+    SlimTick latest;
+    EXPECT_FALSE(reader.read_latest(0, latest));
+
+    bus.publish(bus.index_of("BTC-USD"), make_tick("BTC-USD", 1));
+    bus.publish(bus.index_of("ETH-USD"), make_tick("ETH-USD", 2));
+    bus.publish(bus.index_of("BTC-USD"), make_tick("BTC-USD", 3));
+
+    for (uint64_t expected : {1u, 2u, 3u}) {
+        SlimTick* tick = reader.acquire_filled_slot();
+        ASSERT_NE(tick, nullptr);
+        EXPECT_EQ(tick->sequence, expected);
+        reader.release_slot();
+    }
+    EXPECT_EQ(reader.acquire_filled_slot(), nullptr);
+
+    ASSERT_TRUE(reader.read_latest(reader.index_of("BTC-USD"), latest));
+    EXPECT_EQ(latest.sequence, 3u);
+    EXPECT_EQ(latest.price, Decimal64(3, 0));
+    EXPECT_FALSE(reader.producer_stale(1000000000ull));
+}
+
+TEST(ShmBusTest, LappedReaderSkipsAheadAndCounts) {
+    ShmTickBus<SlimTick> bus(BUS_NAME, {"BTC-USD"}, 4);
+    ShmTickBusReader<SlimTick> reader(BUS_NAME);
+
+    for (uint64_t seq = 0; seq < 10; ++seq) bus.publish(0, make_tick("BTC-USD", seq));
+
+    // Only the last capacity ticks are left
+    std::vector<uint64_t> seen;
+    while (SlimTick* tick = reader.acquire_filled_slot()) {
+        seen.push_back(tick->sequence);
+        reader.release_slot();
+    }
+    EXPECT_EQ(seen, (std::vector<uint64_t>{6, 7, 8, 9}));
+    EXPECT_EQ(reader.dropped(), 6u);
+}
+
+TEST(ShmBusTest, RejectsMismatchedLayout) {
+    ShmTickBus<SlimTick> bus(BUS_NAME, {"BTC-USD"}, 4);
+    EXPECT_THROW(ShmTickBusReader<Tick> reader(BUS_NAME), std::runtime_error);
+    EXPECT_THROW(ShmTickBusReader<SlimTick> reader("/sparkland-does-not-exist"), std::runtime_error);
+}
+
+TEST(ShmBusTest, ProducerShutdownIsVisible) {
+    auto bus = std::make_unique<ShmTickBus<SlimTick>>(BUS_NAME, std::vector<std::string>{"BTC-USD"}, 4);
+    ShmTickBusReader<SlimTick> reader(BUS_NAME);
+    bus->publish(0, make_tick("BTC-USD", 7));
+    bus.reset();
+
+    // The mapping outlives the producer, the last tick is still readable
+    EXPECT_TRUE(reader.producer_stale(1000000000ull));
+    SlimTick* tick = reader.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_EQ(tick->sequence, 7u);
+}
+
+TEST(ShmBusTest, OtherProcessReadsEveryTick) {
+    constexpr uint64_t TICKS = 100000;
+    ShmTickBus<SlimTick> bus(BUS_NAME, {"BTC-USD"}, 1024);
+
+    int ready[2];
+    ASSERT_EQ(pipe(ready), 0);
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Consumer process: count ticks in order, exit code reports the outcome
+        ShmTickBusReader<SlimTick> reader(BUS_NAME);
+        char byte = 1;
+        if (write(ready[1], &byte, 1) != 1) _exit(3);
+        uint64_t expected = 0;
+        while (expected < TICKS) {
+            SlimTick* tick = reader.acquire_filled_slot();
+            if (!tick) continue;
+            if (tick->sequence != expected) _exit(1);
+            reader.release_slot();
+            ++expected;
+        }
+        _exit(reader.dropped() == 0 ? 0 : 2);
+    }
+
+    char byte;
+    ASSERT_EQ(read(ready[0], &byte, 1), 1);
+    // Paced so the consumer never gets lapped, readers can't slow the producer down
+    for (uint64_t seq = 0; seq < TICKS; ++seq) {
+        bus.publish(0, make_tick("BTC-USD", seq));
+        if (seq % 512 == 511) usleep(200);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    close(ready[0]);
+    close(ready[1]);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(ShmBusTest, ParserPublishesToBus) {
+    std::vector<std::string> products = {"BTC-USD"};
+    TickRingBuffer ring;
+    ShmTickBus<Tick> bus(BUS_NAME, products, 16);
+    ShmTickBusReader<Tick> reader(BUS_NAME);
+    TickParser parser(ring, products);
+    parser.set_shm_bus(&bus);
+
+    simdjson::padded_string json(std::string(
+        R"({"type": "ticker", "sequence": 42, "product_id": "BTC-USD", "price": "100.5", "best_bid": "100", "best_ask": "101"})"));
+    ASSERT_TRUE(parser.parse_and_push(json));
+
+    Tick* tick = reader.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_EQ(tick->sequence, 42u);
+    EXPECT_STREQ(tick->product_id, "BTC-USD");
+    Tick latest;
+    ASSERT_TRUE(reader.read_latest(0, latest));
+    EXPECT_EQ(latest.price, Decimal64(1005, 1));
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "sparkland/snapshot_cache.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace sparkland;
+
+TEST(SnapshotCacheTest, UnknownAndUnsetProducts) {
+    SnapshotCache cache({"BTC-USD", "ETH-USD"});
+    TopOfBook top;
+
+    EXPECT_EQ(cache.index_of("ETH-USD"), 1);
+    EXPECT_EQ(cache.index_of("DOGE-USD"), -1);
+    EXPECT_FALSE(cache.read("DOGE-USD", top));
+    EXPECT_FALSE(cache.read("BTC-USD", top));  // never written
+    EXPECT_FALSE(cache.update("DOGE-USD", top));
+}
+
+TEST(SnapshotCacheTest, ReadReturnsLatestWrite) {
+    SnapshotCache cache({"BTC-USD"});
+
+    TopOfBook top;
+    top.price = Decimal64(11113556, 2);
+    top.sequence = 42;
+    top.price_ema = 111135.0;
+    ASSERT_TRUE(cache.update("BTC-USD", top));
+
+    top.sequence = 43;
+    cache.update(0, top);
+
+    TopOfBook out;
+    ASSERT_TRUE(cache.read("BTC-USD", out));
+    EXPECT_EQ(out.sequence, 43);
+    EXPECT_EQ(out.price, Decimal64(11113556, 2));
+    EXPECT_DOUBLE_EQ(out.price_ema, 111135.0);
+    EXPECT_EQ(cache.version(0), 2);
+}
+
+TEST(SnapshotCacheTest, ConcurrentReadersSeeConsistentSnapshots) {
+    SnapshotCache cache({"BTC-USD"});
+    std::atomic<bool> done{false};
+    std::atomic<size_t> torn{0};
+
+    // Writer keeps every field derived from the same counter
+    std::thread writer([&]() {
+        TopOfBook top;
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            top.sequence = i;
+            top.price = Decimal64(static_cast<int64_t>(i), 2);
+            top.best_bid_size = Decimal64(static_cast<int64_t>(i), 8);
+            top.price_ema = static_cast<double>(i);
+            cache.update(0, top);
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            TopOfBook out;
+            uint64_t last_seen = 0;
+            while (!done) {
+                if (!cache.read(0, out)) continue;
+                int64_t seq = static_cast<int64_t>(out.sequence);
+                if (out.price.units() != seq || out.best_bid_size.units() != seq ||
+                    out.price_ema != static_cast<double>(seq) || out.sequence < last_seen) {
+                    ++torn;
+                }
+                last_seen = out.sequence;
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) reader.join();
+
+    EXPECT_EQ(torn.load(), 0u);
+    TopOfBook last;
+    ASSERT_TRUE(cache.read(0, last));
+    EXPECT_EQ(last.sequence, 200000u);
+}
+
+TEST(SnapshotCacheTest, UpdatedByTickParser) {
+    std::vector<std::string> products = {"BTC-USD", "ETH-USD"};
+    TickRingBuffer ring_buffer;
+    SnapshotCache cache(products);
+    TickParser parser(ring_buffer, products, &cache);
+
+    std::string json = R"({
+        "type": "ticker",
+        "sequence": 111484916886,
+        "product_id": "ETH-USD",
+        "price": "4305.0",
+        "best_bid": "4304.98",
+        "best_bid_size": "0.0450549",
+        "best_ask": "4305.1",
+        "best_ask_size": "0.00222536"
+    })";
+    simdjson::padded_string payload(json);
+    ASSERT_TRUE(parser.parse_and_push(payload));
+
+    TopOfBook top;
+    ASSERT_TRUE(cache.read("ETH-USD", top));
+    EXPECT_EQ(top.sequence, 111484916886u);
+    EXPECT_EQ(top.price, Decimal64(43050, 1));
+    EXPECT_EQ(top.best_bid, Decimal64(430498, 2));
+    EXPECT_EQ(top.best_ask_size, Decimal64(222536, 8));
+    EXPECT_EQ(top.mid_price, Decimal64(430504, 2));
+    EXPECT_DOUBLE_EQ(top.price_ema, 4305.0);
+
+    EXPECT_FALSE(cache.read("BTC-USD", top));
+}
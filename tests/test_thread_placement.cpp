@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "sparkland/thread_placement.h"
+#include <numeric>
+#include <vector>
+
+using namespace sparkland;
+
+TEST(ThreadPlacementTest, ParsesCpuLists) {
+    EXPECT_EQ(parse_cpu_list("2-5,8\n"), (std::vector<int>{2, 3, 4, 5, 8}));
+    EXPECT_EQ(parse_cpu_list("0"), std::vector<int>{0});
+    EXPECT_TRUE(parse_cpu_list("").empty());
+    EXPECT_TRUE(parse_cpu_list("\n").empty());
+    EXPECT_EQ(parse_cpu_list("1,x,3"), (std::vector<int>{1, 3}));
+}
+
+TEST(ThreadPlacementTest, ResolveKeepsExplicitCpus) {
+    EXPECT_EQ(resolve_cpu(-1), -1);
+    EXPECT_EQ(resolve_cpu(0), 0);
+
+    // Auto only ever hands out isolated CPUs
+    std::vector<int> isolated = isolated_cpus();
+    int cpu = resolve_cpu(AUTO_ISOLATED_CPU);
+    if (isolated.empty()) {
+        EXPECT_EQ(cpu, -1);
+    } else {
+        EXPECT_EQ(cpu, isolated.front());
+    }
+}
+
+TEST(ThreadPlacementTest, DefaultPlacementIsNoOp) {
+    EXPECT_TRUE(apply_thread_placement({}));
+    EXPECT_TRUE(pin_current_thread(-1));
+}
+
+TEST(ThreadPlacementTest, PrefaultKeepsContents) {
+    std::vector<int> data(100000);
+    std::iota(data.begin(), data.end(), 0);
+    prefault_memory(data.data(), data.size() * sizeof(int));
+    for (size_t i = 0; i < data.size(); ++i) {
+        ASSERT_EQ(data[i], static_cast<int>(i));
+    }
+    prefault_memory(nullptr, 0);
+    prefault_stack();
+}
@@ -89,17 +89,20 @@ TEST_F(TickParserTest, ParsedDataIntegrity) {
     EXPECT_STREQ(tick->side, "sell");
     EXPECT_EQ(tick->sequence, 111484916886);
     EXPECT_EQ(tick->trade_id, 871379421);
-    EXPECT_DOUBLE_EQ(tick->price, 4305.0);
-    EXPECT_DOUBLE_EQ(tick->open_24h, 1689.62789966);
-    EXPECT_DOUBLE_EQ(tick->volume_24h, 1234.56);
-    EXPECT_DOUBLE_EQ(tick->best_bid, 4304.98);
-    EXPECT_DOUBLE_EQ(tick->best_ask, 4305.1);
-    EXPECT_DOUBLE_EQ(tick->best_bid_size, 0.0450549);
-    EXPECT_DOUBLE_EQ(tick->best_ask_size, 0.00222536);
-    
-    // Verify calculated mid price
-    double expected_mid = (4304.98 + 4305.1) / 2.0;
-    EXPECT_DOUBLE_EQ(tick->mid_price, expected_mid);
+    EXPECT_DOUBLE_EQ(tick->price.to_double(), 4305.0);
+    EXPECT_DOUBLE_EQ(tick->open_24h.to_double(), 1689.62789966);
+    EXPECT_DOUBLE_EQ(tick->volume_24h.to_double(), 1234.56);
+    EXPECT_DOUBLE_EQ(tick->best_bid.to_double(), 4304.98);
+    EXPECT_DOUBLE_EQ(tick->best_ask.to_double(), 4305.1);
+    EXPECT_DOUBLE_EQ(tick->best_bid_size.to_double(), 0.0450549);
+    EXPECT_DOUBLE_EQ(tick->best_ask_size.to_double(), 0.00222536);
+    
+    // Decimal fields keep the exact wire value
+    EXPECT_EQ(tick->price, Decimal64(43050, 1));
+    EXPECT_EQ(tick->best_bid, Decimal64(430498, 2));
+
+    // Verify calculated mid price is exact
+    EXPECT_EQ(tick->mid_price, Decimal64(430504, 2));
     
     ring_buffer.release_slot();
 }
@@ -116,6 +119,59 @@ TEST_F(TickParserTest, InvalidJsonHandling) {
     bool result = parser->parse_and_push(payload);
     EXPECT_FALSE(result);  // Should return false for invalid JSON
     EXPECT_TRUE(ring_buffer.empty());
+    EXPECT_EQ(parser->stats().json_errors, 1u);
+    EXPECT_NE(parser->stats().last_error, simdjson::SUCCESS);
+}
+
+TEST_F(TickParserTest, OversizedFieldsAreTruncatedAndCounted) {
+    std::string json_str = createTickerJson();
+    json_str.replace(json_str.find("\"sell\""), 6, "\"" + std::string(64, 's') + "\"");
+    simdjson::padded_string payload(json_str);
+
+    ASSERT_TRUE(parser->parse_and_push(payload));
+    Tick* tick = ring_buffer.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_EQ(std::string(tick->side), std::string(sizeof(tick->side) - 1, 's'));
+    EXPECT_STREQ(tick->product_id, "BTC-USD");
+    EXPECT_EQ(parser->stats().truncated_fields, 1u);
+    ring_buffer.release_slot();
+
+    // A cut product id could name another product, the tick is dropped
+    simdjson::padded_string long_product(createTickerJson("BTC-USD" + std::string(100, 'X')));
+    EXPECT_FALSE(parser->parse_and_push(long_product));
+    EXPECT_TRUE(ring_buffer.empty());
+    EXPECT_EQ(parser->stats().truncated_fields, 2u);
+}
+
+TEST_F(TickParserTest, UnknownAndMistypedInputIsCounted) {
+    simdjson::padded_string unknown(createTickerJson("SOL-USD"));
+    EXPECT_FALSE(parser->parse_and_push(unknown));
+    EXPECT_EQ(parser->stats().unknown_products, 1u);
+
+    simdjson::padded_string mistyped(std::string(R"({"type": "ticker", "product_id": 42})"));
+    EXPECT_FALSE(parser->parse_and_push(mistyped));
+    EXPECT_EQ(parser->stats().json_errors, 1u);
+
+    // Book levels missing their size
+    simdjson::padded_string short_level(std::string(
+        R"({"type": "l2update", "product_id": "BTC-USD", "changes": [["buy", "100.5"]]})"));
+    EXPECT_FALSE(parser->parse_and_push(short_level));
+    EXPECT_TRUE(ring_buffer.empty());
+    EXPECT_EQ(parser->stats().malformed_numbers, 0u);
+
+    // Malformed numbers read as 0 on ticks and reject book levels, both counted
+    simdjson::padded_string bad_price(createTickerJson("BTC-USD", "12.3.4"));
+    ASSERT_TRUE(parser->parse_and_push(bad_price));
+    Tick* tick = ring_buffer.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_TRUE(tick->price.is_zero());
+    ring_buffer.release_slot();
+    EXPECT_EQ(parser->stats().malformed_numbers, 1u);
+
+    simdjson::padded_string bad_level(std::string(
+        R"({"type": "l2update", "product_id": "BTC-USD", "changes": [["buy", "abc", "1"]]})"));
+    EXPECT_FALSE(parser->parse_and_push(bad_level));
+    EXPECT_EQ(parser->stats().malformed_numbers, 2u);
 }
 
 TEST_F(TickParserTest, EMACalculation) {
@@ -170,14 +226,14 @@ TEST_F(TickParserTest, MissingFieldsHandling) {
     // Essential fields should be present
     EXPECT_STREQ(tick->type, "ticker");
     EXPECT_STREQ(tick->product_id, "BTC-USD");
-    EXPECT_DOUBLE_EQ(tick->price, 110000.0);
-    EXPECT_DOUBLE_EQ(tick->best_bid, 110000.0);
-    EXPECT_DOUBLE_EQ(tick->best_ask, 110000.1);
+    EXPECT_DOUBLE_EQ(tick->price.to_double(), 110000.0);
+    EXPECT_DOUBLE_EQ(tick->best_bid.to_double(), 110000.0);
+    EXPECT_DOUBLE_EQ(tick->best_ask.to_double(), 110000.1);
     
     // Missing fields should have default values
     EXPECT_EQ(tick->sequence, 0);
     EXPECT_EQ(tick->trade_id, 0);
-    EXPECT_DOUBLE_EQ(tick->open_24h, 0.0);
+    EXPECT_DOUBLE_EQ(tick->open_24h.to_double(), 0.0);
     EXPECT_STREQ(tick->side, "");
     
     ring_buffer.release_slot();
@@ -200,4 +256,102 @@ TEST_F(TickParserTest, BufferFullHandling) {
     // Try to add one more - should fail
     bool result = parser->parse_and_push(payload);
     EXPECT_FALSE(result);  // Should return false when buffer is full
-}
\ No newline at end of file
+}
+TEST_F(TickParserTest, SlimProfileParsesSelectedFields) {
+    static_assert(!SlimTick::has(tick_fields::STATS_24H) && SlimTick::has(tick_fields::SEQUENCE));
+    static_assert(sizeof(SlimTick) < sizeof(Tick) / 2, "unused groups take no space");
+
+    SlimTickBroadcastRing ring;
+    auto& consumer = ring.add_consumer();
+    SlimBroadcastTickParser slim_parser(ring, product_ids);
+
+    std::string json_str = createTickerJson("ETH-USD", "4305.03", "4305.02", "4305.06");
+    simdjson::padded_string payload(json_str);
+    ASSERT_TRUE(slim_parser.parse_and_push(payload));
+
+    SlimTick* tick = consumer.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    EXPECT_STREQ(tick->product_id, "ETH-USD");
+    EXPECT_EQ(tick->sequence, 111484916886u);
+    EXPECT_EQ(tick->price, Decimal64(430503, 2));
+    EXPECT_EQ(tick->best_bid, Decimal64(430502, 2));
+    EXPECT_EQ(tick->best_ask_size, Decimal64(222536, 8));
+    EXPECT_EQ(tick->mid_price, Decimal64(430504, 2));
+    EXPECT_GT(tick->price_ema, 0.0);
+    consumer.release_slot();
+}
+
+TEST_F(TickParserTest, BatchPublishesAllTicksTogether) {
+    // Frames of one socket read: two tickers, a heartbeat and a third ticker
+    std::string batch = createTickerJson("BTC-USD", "110000.5") + "\n" +
+                        createTickerJson("ETH-USD", "4305.03") + "\n" +
+                        R"({"type": "heartbeat", "sequence": 1})" + "\n" +
+                        createTickerJson("BTC-USD", "110001.5");
+    simdjson::padded_string payload(batch);
+
+    EXPECT_EQ(parser->parse_batch(payload), 0u);
+    ASSERT_EQ(ring_buffer.size(), 3u);
+
+    const char* products[] = {"BTC-USD", "ETH-USD", "BTC-USD"};
+    double prices[] = {110000.5, 4305.03, 110001.5};
+    for (int i = 0; i < 3; ++i) {
+        Tick* tick = ring_buffer.acquire_filled_slot();
+        ASSERT_NE(tick, nullptr);
+        EXPECT_STREQ(tick->product_id, products[i]);
+        EXPECT_DOUBLE_EQ(tick->price.to_double(), prices[i]);
+        ring_buffer.release_slot();
+    }
+
+    // Single messages still publish immediately after a batch
+    simdjson::padded_string single(createTickerJson());
+    EXPECT_TRUE(parser->parse_and_push(single));
+    EXPECT_EQ(ring_buffer.size(), 1u);
+}
+
+TEST_F(TickParserTest, BatchStopsAtFullRing) {
+    std::string batch;
+    for (size_t i = 0; i < ring_buffer.capacity() + 5; ++i) {
+        batch += createTickerJson() + "\n";
+    }
+    simdjson::padded_string payload(batch);
+
+    EXPECT_EQ(parser->parse_batch(payload), 5u);
+    EXPECT_EQ(ring_buffer.size(), ring_buffer.capacity());
+}
+
+TEST_F(TickParserTest, BatchResumesAfterMalformedFrame) {
+    // One frame per line as the client joins them, the second one's string is never closed
+    std::string batch = std::string(R"({"type": "ticker", "product_id": "BTC-USD", "price": "100"})") + "\n" +
+                        R"({"type": "ticker", "product_id": "BTC-USD", "price": "1)" + "\n" +
+                        R"({"type": "ticker", "product_id": "ETH-USD", "price": "200"})" + "\n";
+    simdjson::padded_string payload(batch);
+
+    EXPECT_EQ(parser->parse_batch(payload), 1u);
+    EXPECT_EQ(parser->stats().json_errors, 1u);
+    ASSERT_EQ(ring_buffer.size(), 2);
+    EXPECT_STREQ(ring_buffer.acquire_filled_slot()->product_id, "BTC-USD");
+    ring_buffer.release_slot();
+    EXPECT_STREQ(ring_buffer.acquire_filled_slot()->product_id, "ETH-USD");
+}
+
+TEST_F(TickParserTest, BatchResumesAfterDocumentMalformedHalfWay) {
+    // Good, bad, good: the middle frame breaks off inside its product_id, which simdjson only
+    // finds while reading the document
+    std::string batch = std::string(R"({"type": "ticker", "product_id": "BTC-USD", "price": "100"})") + "\n" +
+                        R"({"type": "ticker", "product_id:47:52.369411Z"})" + "\n" +
+                        R"({"type": "ticker", "product_id": "ETH-USD", "price": "200"})";
+    simdjson::padded_string payload(batch);
+
+    EXPECT_EQ(parser->parse_batch(payload), 1u);
+    EXPECT_EQ(parser->stats().json_errors, 1u);
+    ASSERT_EQ(ring_buffer.size(), 2);
+    EXPECT_STREQ(ring_buffer.acquire_filled_slot()->product_id, "BTC-USD");
+    ring_buffer.release_slot();
+    EXPECT_STREQ(ring_buffer.acquire_filled_slot()->product_id, "ETH-USD");
+    ring_buffer.release_slot();
+
+    // The parser is fine for the next read
+    simdjson::padded_string next(createTickerJson());
+    EXPECT_EQ(parser->parse_batch(next), 0u);
+    EXPECT_EQ(ring_buffer.size(), 1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "sparkland/ticker_generator.h"
+#include "sparkland/feed_latency.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+using namespace sparkland;
+
+namespace {
+
+// 2025-09-07T08:47:52.369411Z
+constexpr int64_t SEND_NS = 1757234872369411000;
+
+}
+
+TEST(TickerGeneratorTest, SyntheticFeedIsDeterministic) {
+    FeedProfile profile;
+    profile.product_count = 2;
+    profile.seed = 7;
+    TickerGenerator first(profile);
+    TickerGenerator second(profile);
+    EXPECT_EQ(first.products(), (std::vector<std::string>{"SIM000-USD", "SIM001-USD"}));
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(first.next(SEND_NS + i), second.next(SEND_NS + i));
+    }
+    EXPECT_EQ(first.generated(), 100u);
+
+    TickerGenerator seed_7(profile);
+    profile.seed = 8;
+    TickerGenerator seed_8(profile);
+    EXPECT_NE(seed_7.next(SEND_NS), seed_8.next(SEND_NS));
+}
+
+TEST(TickerGeneratorTest, ProductCountIsBoundedByIdWidth) {
+    FeedProfile profile;
+    profile.product_count = MAX_SYNTHETIC_PRODUCTS;
+    TickerGenerator generator(profile);
+    EXPECT_EQ(generator.products().back(), "SIM999-USD");
+
+    profile.product_count = MAX_SYNTHETIC_PRODUCTS + 1;
+    EXPECT_THROW(TickerGenerator{profile}, std::invalid_argument);
+}
+
+TEST(TickerGeneratorTest, SyntheticMessagesParse) {
+    FeedProfile profile;
+    profile.product_count = 3;
+    TickerGenerator generator(profile);
+
+    TickRingBuffer ring;
+    TickParser parser(ring, generator.products());
+    for (int i = 0; i < 6; ++i) {
+        simdjson::padded_string payload(generator.next(SEND_NS));
+        ASSERT_TRUE(parser.parse_and_push(payload)) << generator.next(SEND_NS);
+    }
+
+    // Round robin over the products, sequence counts messages
+    for (uint64_t i = 0; i < 6; ++i) {
+        Tick* tick = ring.acquire_filled_slot();
+        ASSERT_NE(tick, nullptr);
+        EXPECT_EQ(tick->product_id, generator.products()[i % 3]);
+        EXPECT_EQ(tick->sequence, i + 1);
+        EXPECT_EQ(parse_exchange_time(tick->time), SEND_NS);
+        EXPECT_LT(tick->best_bid, tick->best_ask);
+        EXPECT_GT(tick->last_size, Decimal64());
+        ring.release_slot();
+    }
+}
+
+TEST(TickerGeneratorTest, ReplaysRecordedTickersWithSendTime) {
+    const std::string path = "test_replay.jsonl";
+    {
+        std::ofstream file(path);
+        file << R"({"type":"subscriptions","channels":[]})" << "\n"
+             << R"({"type": "ticker", "product_id": "ETH-USD", "price": "4305.03", "time": "2025-09-07T08:47:52.369411Z"})" << "\n"
+             << "\n"
+             << R"({"type": "ticker", "product_id": "BTC-USD", "price": "111135.56"})" << "\n";
+    }
+    FeedProfile profile;
+    profile.replay_path = path;
+    TickerGenerator generator(profile);
+    EXPECT_EQ(generator.products(), (std::vector<std::string>{"ETH-USD", "BTC-USD"}));
+
+    EXPECT_EQ(generator.next(SEND_NS + 1000000),
+              R"({"type": "ticker", "product_id": "ETH-USD", "price": "4305.03", "time": "2025-09-07T08:47:52.370411Z"})");
+    EXPECT_EQ(generator.next(SEND_NS), R"({"type": "ticker", "product_id": "BTC-USD", "price": "111135.56"})");
+    // Looped
+    EXPECT_NE(generator.next(SEND_NS).find("ETH-USD"), std::string::npos);
+    std::remove(path.c_str());
+
+    profile.replay_path = "does-not-exist.jsonl";
+    EXPECT_THROW(TickerGenerator missing(profile), std::runtime_error);
+}
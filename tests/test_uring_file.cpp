@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "sparkland/uring_file.h"
+#include "sparkland/segmented_file.h"
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+using namespace sparkland;
+namespace fs = std::filesystem;
+
+class UringFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!UringFileBuf::available()) GTEST_SKIP() << "io_uring is not available";
+        fs::remove(path);
+    }
+
+    void TearDown() override {
+        fs::remove(path);
+    }
+
+    static std::string read_file(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    // Rows spanning many buffers so writes are recycled, none a multiple of the block size
+    static std::string rows(int count, const std::string& prefix) {
+        std::string content;
+        for (int i = 0; i < count; ++i) content += prefix + ",BTC-USD,111000.12," + std::to_string(i) + "\n";
+        return content;
+    }
+
+    std::string path = "test_uring.csv";
+};
+
+TEST_F(UringFileTest, WritesThroughRecycledBuffers) {
+    const std::string content = rows(5000, "a");
+    {
+        // Two small buffers, the writer has to wait for completions to get a buffer back
+        UringFileBuf buffer(2, DIRECT_IO_ALIGNMENT);
+        ASSERT_TRUE(buffer.open(path, false));
+        std::ostream out(&buffer);
+        out << content;
+        EXPECT_EQ(buffer.size(), content.size());
+    }
+    EXPECT_EQ(read_file(path), content);
+}
+
+TEST_F(UringFileTest, AppendsToExistingFile) {
+    std::ofstream(path) << "header\n";
+    const std::string content = rows(1000, "b");
+    {
+        UringFileBuf buffer;
+        ASSERT_TRUE(buffer.open(path, false));
+        EXPECT_EQ(buffer.size(), 7u);
+        std::ostream(&buffer) << content;
+    }
+    EXPECT_EQ(read_file(path), "header\n" + content);
+}
+
+TEST_F(UringFileTest, DirectIoKeepsExactSize) {
+    // Existing content that doesn't end on a block boundary, then more than a buffer of rows.
+    // Falls back to buffered I/O where the filesystem (e.g. tmpfs) has no O_DIRECT
+    std::ofstream(path) << "header\n";
+    const std::string first = rows(3000, "c");
+    const std::string second = rows(10, "d");
+    {
+        UringFileBuf buffer(4, 16 * DIRECT_IO_ALIGNMENT);
+        ASSERT_TRUE(buffer.open(path, true));
+        std::ostream(&buffer) << first;
+    }
+    {
+        UringFileBuf buffer(4, 16 * DIRECT_IO_ALIGNMENT);
+        ASSERT_TRUE(buffer.open(path, true));
+        std::ostream(&buffer) << second;
+    }
+    EXPECT_EQ(fs::file_size(path), 7 + first.size() + second.size());
+    EXPECT_EQ(read_file(path), "header\n" + first + second);
+}
+
+TEST_F(UringFileTest, SyncMakesBufferedDataVisible) {
+    UringFileBuf buffer;
+    ASSERT_TRUE(buffer.open(path, false));
+    std::ostream out(&buffer);
+    out << "row\n" << std::flush;
+
+    // The write is asynchronous, reopening finishes it
+    ASSERT_TRUE(buffer.open(path, false));
+    EXPECT_EQ(read_file(path), "row\n");
+    EXPECT_EQ(buffer.size(), 4u);
+    EXPECT_EQ(buffer.write_errors(), 0u);
+}
+
+TEST_F(UringFileTest, SegmentedFileRotatesWithUring) {
+    const std::string dir = "test_uring_segments";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    OutputPolicy policy;
+    policy.writer = FileWriter::IoUring;
+    policy.max_bytes = 1000;
+    {
+        SegmentedFile file(dir + "/ticks.csv", policy);
+        ASSERT_NE(file.uring(), nullptr);
+        bool rotated = false;
+        for (uint32_t i = 0; i < ROTATION_CHECK_RECORDS && !rotated; ++i) {
+            file.stream() << "0123456789\n";
+            rotated = file.record_written();
+        }
+        EXPECT_TRUE(rotated);
+        EXPECT_TRUE(file.needs_header());
+        file.stream() << "next\n";
+    }
+    EXPECT_EQ(fs::file_size(dir + "/ticks.0000.csv"), 11u * ROTATION_CHECK_RECORDS);
+    EXPECT_EQ(read_file(dir + "/ticks.0001.csv"), "next\n");
+    fs::remove_all(dir);
+}
+
+TEST_F(UringFileTest, FallsBackWithoutWriteSupport) {
+    // A kernel before 5.6 sets up a ring but has no IORING_REGISTER_PROBE (EINVAL) and no
+    // IORING_OP_WRITE. Emulated in a child process by failing io_uring_register with seccomp
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        sock_filter filter[] = {
+            BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_register, 0, 1),
+            BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EINVAL),
+            BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+        };
+        sock_fprog program{static_cast<unsigned short>(sizeof(filter) / sizeof(filter[0])), filter};
+        if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 ||
+            prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) != 0) {
+            _exit(77);
+        }
+
+        try {
+            UringFileBuf buffer;
+            _exit(1);  // the ring was set up but its writes would all fail
+        } catch (const std::runtime_error&) {
+        }
+
+        OutputPolicy policy;
+        policy.writer = FileWriter::IoUring;
+        {
+            SegmentedFile file(path, policy);
+            if (file.uring() != nullptr) _exit(2);
+            file.stream() << "row\n";
+        }
+        _exit(read_file(path) == "row\n" ? 0 : 3);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    if (WEXITSTATUS(status) == 77) GTEST_SKIP() << "seccomp is not available";
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
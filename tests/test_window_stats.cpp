@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "sparkland/window_stats.h"
+#include "sparkland/tick_parser.h"
+#include "sparkland/types.h"
+#include <cmath>
+#include <string>
+
+using namespace sparkland;
+
+namespace {
+
+constexpr int64_t SECOND_NS = 1000000000;
+
+}
+
+TEST(RollingWindowTest, AggregatesTicksWithinWindow) {
+    RollingWindow window(5);
+    EXPECT_EQ(window.value().tick_count, 0u);
+
+    window.add(100 * SECOND_NS, 100.0, 1.0, 0.02, 0.0);
+    window.add(101 * SECOND_NS, 102.0, 3.0, 0.04, 0.0004);
+    window.add(102 * SECOND_NS, 101.0, 1.0, 0.06, 0.0005);
+
+    WindowStat stat = window.value();
+    EXPECT_EQ(stat.tick_count, 3u);
+    // (100*1 + 102*3 + 101*1) / 5
+    EXPECT_DOUBLE_EQ(stat.vwap, 101.4);
+    EXPECT_DOUBLE_EQ(stat.volatility, std::sqrt(0.0009));
+    EXPECT_DOUBLE_EQ(stat.mean_spread, 0.04);
+}
+
+TEST(RollingWindowTest, ExpiresTicksOlderThanWindow) {
+    RollingWindow window(5);
+    window.add(100 * SECOND_NS, 100.0, 1.0, 0.01, 0.0);
+    window.add(103 * SECOND_NS, 110.0, 1.0, 0.03, 0.0);
+
+    // The first tick slides out once its bucket is a full window old
+    window.advance(105 * SECOND_NS + SECOND_NS / 4);
+    WindowStat stat = window.value();
+    EXPECT_EQ(stat.tick_count, 1u);
+    EXPECT_DOUBLE_EQ(stat.vwap, 110.0);
+    EXPECT_DOUBLE_EQ(stat.mean_spread, 0.03);
+
+    // A gap longer than the window empties it
+    window.advance(1000 * SECOND_NS);
+    EXPECT_EQ(window.value().tick_count, 0u);
+    EXPECT_DOUBLE_EQ(window.value().vwap, 0.0);
+}
+
+TEST(RollingWindowTest, ZeroVolumeHasNoVwap) {
+    RollingWindow window(1);
+    window.add(SECOND_NS, 100.0, 0.0, 0.5, 0.0);
+    EXPECT_EQ(window.value().tick_count, 1u);
+    EXPECT_DOUBLE_EQ(window.value().vwap, 0.0);
+    EXPECT_DOUBLE_EQ(window.value().mean_spread, 0.5);
+}
+
+TEST(WindowStatsTest, WindowsKeepTheirOwnHistory) {
+    WindowStats stats;
+    WindowStat out[STATS_WINDOWS_S.size()];
+    auto start = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+
+    stats.update(100.0, 1.0, 99.5, 100.5, start, out);
+    stats.update(110.0, 1.0, 109.5, 110.5, start + std::chrono::seconds(3), out);
+
+    // 1 s window only has the second tick, 5 s and 60 s both
+    EXPECT_EQ(out[0].tick_count, 1u);
+    EXPECT_DOUBLE_EQ(out[0].vwap, 110.0);
+    EXPECT_EQ(out[1].tick_count, 2u);
+    EXPECT_DOUBLE_EQ(out[1].vwap, 105.0);
+    EXPECT_EQ(out[2].tick_count, 2u);
+    EXPECT_DOUBLE_EQ(out[2].mean_spread, 1.0);
+
+    // Tick-to-tick log return, tracked across windows
+    double log_return = std::log(110.0 / 100.0);
+    EXPECT_DOUBLE_EQ(out[0].volatility, std::abs(log_return));
+    EXPECT_DOUBLE_EQ(out[2].volatility, std::abs(log_return));
+}
+
+TEST(WindowStatsTest, ParserFillsWindowColumns) {
+    static_assert(Tick::has(tick_fields::WINDOW_STATS) && !SlimTick::has(tick_fields::WINDOW_STATS));
+
+    TickRingBuffer ring;
+    TickParser parser(ring, {"BTC-USD"});
+    for (const char* price : {"100", "101"}) {
+        std::string json = std::string(R"({"type": "ticker", "product_id": "BTC-USD", "price": ")") + price +
+                           R"(", "best_bid": "99", "best_ask": "101", "last_size": "2"})";
+        simdjson::padded_string payload(json);
+        ASSERT_TRUE(parser.parse_and_push(payload));
+    }
+
+    ASSERT_EQ(ring.size(), 2u);
+    ASSERT_NE(ring.acquire_filled_slot(), nullptr);
+    ring.release_slot();
+    Tick* tick = ring.acquire_filled_slot();
+    ASSERT_NE(tick, nullptr);
+    for (const WindowStat& stat : tick->window_stats) {
+        EXPECT_EQ(stat.tick_count, 2u);
+        EXPECT_DOUBLE_EQ(stat.vwap, 100.5);
+        EXPECT_DOUBLE_EQ(stat.mean_spread, 2.0);
+        EXPECT_DOUBLE_EQ(stat.volatility, std::log(101.0 / 100.0));
+    }
+}